@@ -0,0 +1,10 @@
+// Functions wrapped twice, through the CxxWrap dispatch and, for the _ccall
+// suffixed copies, with ccall, to compare the cost of a call.
+
+namespace bench {
+  inline double axpy(double a, double x, double y){ return a * x + y; }
+  inline double axpy_ccall(double a, double x, double y){ return a * x + y; }
+
+  inline int next(int i){ return i + 1; }
+  inline int next_ccall(int i){ return i + 1; }
+}
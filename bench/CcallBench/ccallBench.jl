@@ -0,0 +1,51 @@
+# Per-call latency of global functions called through the CxxWrap dispatch
+# and with ccall (ccall_functions wrapit parameter). See ../README.md.
+#
+# Usage: julia ccallBench.jl [NCALLS] [NREPEATS], with the CcallBench module
+# in the load path (done by ctest).
+
+using CcallBench
+
+function loop_axpy(f, n)
+    s = 0.0
+    for _ in 1:n
+        s = f(0.5, s, 1.0)
+    end
+    s
+end
+
+function loop_next(f, n)
+    i = Int32(0)
+    for _ in 1:n
+        i = f(i)
+    end
+    i
+end
+
+# best time per call in ns
+function latency(loop, f, n, nrepeats)
+    loop(f, 10) # compilation
+    best = Inf
+    for _ in 1:nrepeats
+        t0 = time_ns()
+        loop(f, n)
+        best = min(best, (time_ns() - t0) / n)
+    end
+    best
+end
+
+ncalls = length(ARGS) > 0 ? parse(Int, ARGS[1]) : 10_000_000
+nrepeats = length(ARGS) > 1 ? parse(Int, ARGS[2]) : 5
+
+cases = [("axpy", loop_axpy, CcallBench.axpy, CcallBench.axpy_ccall),
+         ("next", loop_next, CcallBench.next, CcallBench.next_ccall)]
+
+println(rpad("function", 12), lpad("CxxWrap (ns)", 14), lpad("ccall (ns)", 14), lpad("speedup", 10))
+for (name, loop, f_cxxwrap, f_ccall) in cases
+    loop(f_cxxwrap, 1000) == loop(f_ccall, 1000) || error("$name: results differ")
+    t_cxxwrap = latency(loop, f_cxxwrap, ncalls, nrepeats)
+    t_ccall = latency(loop, f_ccall, ncalls, nrepeats)
+    println(rpad(name, 12), lpad(round(t_cxxwrap, digits=2), 14),
+            lpad(round(t_ccall, digits=2), 14),
+            lpad(round(t_cxxwrap / t_ccall, digits=1), 10))
+end
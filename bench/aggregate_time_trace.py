@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""Aggregates the clang -ftime-trace outputs of wrapper builds into a JSON
+report of the compilation cost of the generated code. See README.md.
+"""
+import argparse
+import json
+import os
+import re
+import sys
+
+INSTANTIATION_EVENTS = ("InstantiateFunction", "InstantiateClass")
+
+# Quantities compared to the baseline: an increase of the gated ones is a
+# regression, the timings, which vary from run to run, are only reported.
+GATED = ("instantiations", "object_size")
+REPORTED = ("frontend_s", "backend_s")
+
+
+def find_traces(build_dir):
+    """Yields the (trace, object file) pairs of a build directory."""
+    for root, _, files in os.walk(build_dir):
+        for f in files:
+            if not f.endswith(".json"):
+                continue
+            base = os.path.join(root, f[:-len(".json")])
+            for obj in (base + ".o", base + ".obj"):
+                if os.path.exists(obj):
+                    yield os.path.join(root, f), obj
+                    break
+
+
+def find_source(build_dir, name, cache={}):
+    """Path of the generated source file name in build_dir, None if not found."""
+    if build_dir not in cache:
+        paths = {}
+        for root, _, files in os.walk(build_dir):
+            for f in files:
+                if f.endswith(".cxx"):
+                    paths.setdefault(f, os.path.join(root, f))
+        cache[build_dir] = paths
+    return cache[build_dir].get(name)
+
+
+def wrapper_classes(source):
+    """Wrapper class name -> wrapped type, for the classes of a generated file."""
+    classes = {}
+    if source is None:
+        return classes
+    re_type = re.compile(r"// Class generating the wrapper for type (.*)")
+    re_struct = re.compile(r"struct (\w+): public Wrapper")
+    wrapped = None
+    with open(source, errors="replace") as f:
+        for line in f:
+            m = re_type.match(line)
+            if m:
+                wrapped = m.group(1).strip()
+                continue
+            m = re_struct.match(line)
+            if m:
+                classes[m.group(1)] = wrapped or "<global>"
+                wrapped = None
+    return classes
+
+
+def analyze(trace_path, obj_path, source):
+    with open(trace_path) as f:
+        events = [e for e in json.load(f).get("traceEvents", [])
+                  if e.get("ph") == "X"]
+
+    def total(name):
+        return sum(e.get("dur", 0) for e in events if e.get("name") == name) * 1e-6
+
+    instantiations = sorted((e for e in events if e.get("name") in INSTANTIATION_EVENTS),
+                            key=lambda e: e.get("ts", 0))
+
+    # Instantiation time attributed to each wrapper class: outermost
+    # instantiations whose detail refers to the class, to not count
+    # nested instantiations twice.
+    classes = wrapper_classes(source)
+    per_class = {c: {"type": t, "instantiation_s": 0.,
+                     "instantiations": 0} for c, t in classes.items()}
+    patterns = {c: re.compile(r"\b%s\b" % re.escape(c)) for c in classes}
+    end_of_counted = {c: -1 for c in classes}
+    for e in instantiations:
+        detail = e.get("args", {}).get("detail", "")
+        for c, p in patterns.items():
+            if not p.search(detail):
+                continue
+            per_class[c]["instantiations"] += 1
+            if e.get("ts", 0) >= end_of_counted[c]:
+                per_class[c]["instantiation_s"] += e.get("dur", 0) * 1e-6
+                end_of_counted[c] = e.get("ts", 0) + e.get("dur", 0)
+
+    return {
+        "frontend_s": total("Frontend"),
+        "backend_s": total("Backend"),
+        "total_s": total("ExecuteCompiler"),
+        "instantiations": len(instantiations),
+        "object_size": os.path.getsize(obj_path),
+        "classes": per_class,
+    }
+
+
+def analyze_case(build_dir):
+    files = {}
+    for trace, obj in find_traces(build_dir):
+        name = os.path.basename(obj)
+        name = name[:name.rfind(".")]
+        if not name.endswith(".cxx"):
+            continue
+        files[name] = analyze(trace, obj, find_source(build_dir, name))
+    totals = {k: sum(f[k] for f in files.values())
+              for k in ("frontend_s", "backend_s", "total_s",
+                        "instantiations", "object_size")}
+    totals["files"] = len(files)
+    return {"totals": totals, "files": files}
+
+
+def compare(report, baseline, threshold):
+    """Returns the list of regressions with respect to baseline and the
+    list of the timing changes, for the case totals, the generated files
+    and the wrapper classes."""
+    regressions = []
+    timings = []
+
+    def check(where, data, ref, keys, out):
+        for k in keys:
+            if k not in data:
+                continue
+            new, old = data[k], ref.get(k, 0)
+            if old > 0 and new > old * (1. + threshold):
+                out.append("%s: %s increased from %g to %g (+%.0f%%)"
+                           % (where, k, old, new, 100. * (new / old - 1.)))
+
+    for case, data in report["cases"].items():
+        ref = baseline.get("cases", {}).get(case)
+        if ref is None:
+            continue
+        check(case, data["totals"], ref["totals"], GATED, regressions)
+        check(case, data["totals"], ref["totals"], REPORTED, timings)
+        for fname, fdata in data["files"].items():
+            fref = ref.get("files", {}).get(fname)
+            if fref is None:
+                continue
+            where = "%s/%s" % (case, fname)
+            check(where, fdata, fref, GATED, regressions)
+            check(where, fdata, fref, REPORTED, timings)
+            for cname, cdata in fdata["classes"].items():
+                cref = fref.get("classes", {}).get(cname)
+                if cref is None:
+                    continue
+                where = "%s/%s/%s" % (case, fname, cname)
+                check(where, cdata, cref, GATED, regressions)
+                check(where, cdata, cref, ("instantiation_s",), timings)
+    return regressions, timings
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("cases", nargs="+", metavar="NAME=BUILD_DIR",
+                        help="Build directory of each case")
+    parser.add_argument("-o", "--output", default="compile-time.json",
+                        help="Path of the JSON report (default: compile-time.json)")
+    parser.add_argument("--baseline",
+                        help="Report of a previous run to compare to")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="Relative increase considered as a regression "
+                        "(default: 0.10)")
+    args = parser.parse_args()
+
+    report = {"cases": {}}
+    for arg in args.cases:
+        name, _, build_dir = arg.partition("=")
+        report["cases"][name] = analyze_case(build_dir or name)
+
+    report["totals"] = {k: sum(c["totals"][k] for c in report["cases"].values())
+                        for k in ("frontend_s", "backend_s", "total_s",
+                                  "instantiations", "object_size", "files")}
+
+    with open(args.output, "w") as f:
+        json.dump(report, f, indent=1, sort_keys=True)
+
+    print("%-28s %6s %12s %12s %10s %12s" % ("case", "files", "frontend (s)",
+                                             "backend (s)", "instances",
+                                             "object (kB)"))
+    for name, c in sorted(report["cases"].items()):
+        t = c["totals"]
+        print("%-28s %6d %12.2f %12.2f %10d %12.1f"
+              % (name, t["files"], t["frontend_s"], t["backend_s"],
+                 t["instantiations"], t["object_size"] / 1024.))
+    print("Report written in %s" % args.output)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            regressions, timings = compare(report, json.load(f), args.threshold)
+        for t in timings:
+            print("Slower: " + t)
+        for r in regressions:
+            print("Regression: " + r)
+        if regressions:
+            sys.exit(2)
+
+
+if __name__ == "__main__":
+    main()
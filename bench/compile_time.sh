@@ -0,0 +1,89 @@
+#!/bin/sh
+#
+# Measures the compilation cost of the code generated by wrapit. The test
+# cases of the test directory and a synthetic header (see gen_synthetic.py)
+# are wrapped and built with clang and its -ftime-trace option. The time
+# traces are aggregated by aggregate_time_trace.py into a JSON report.
+#
+# Usage: compile_time.sh [-b BASELINE] [-n NCLASSES] [-o REPORT] [CASE ...]
+#
+# CASE ...: names of test directories (default: all the Test* directories)
+# -n NCLASSES: number of classes of the synthetic header (default: 200,
+#              0 to skip the synthetic case)
+# -o REPORT: path of the JSON report (default: compile-time.json)
+# -b BASELINE: report of a previous run. The script fails if a number of
+#              template instantiations or an object size increased by more
+#              than 10%. Slower compilation times are only reported.
+#
+# Environment variables:
+#   WRAPIT: path to the wrapit executable (default: wrapit found in PATH)
+#   CXX: clang C++ compiler (default: clang++)
+#   WORKDIR: directory for the builds (default: ./compile-time-bench)
+#   JOBS: number of parallel compilations (default: number of cores)
+#
+set -e
+
+HERE="$(cd "$(dirname "$0")" && pwd)"
+TESTDIR="$HERE/../test"
+
+NCLASSES=200
+REPORT="$PWD/compile-time.json"
+BASELINE=""
+while getopts "b:n:o:" opt; do
+    case $opt in
+        b) BASELINE="$OPTARG";;
+        n) NCLASSES="$OPTARG";;
+        o) REPORT="$OPTARG";;
+        *) sed -n '3,24p' "$0"; exit 1;;
+    esac
+done
+shift $((OPTIND - 1))
+
+WRAPIT="${WRAPIT:-$(command -v wrapit || true)}"
+[ -n "$WRAPIT" ] || { echo "wrapit executable not found. Set WRAPIT." >&2; exit 1; }
+CXX="${CXX:-clang++}"
+WORKDIR="${WORKDIR:-$PWD/compile-time-bench}"
+JOBS="${JOBS:-$(nproc 2>/dev/null || echo 1)}"
+
+if [ $# -gt 0 ]; then
+    CASES="$*"
+else
+    CASES="$(cd "$TESTDIR" && ls -d Test*/ | tr -d /)"
+fi
+
+mkdir -p "$WORKDIR"
+
+# builds the case of source directory $2 in $WORKDIR/$1
+build(){
+    name="$1"
+    src="$2"
+    bld="$WORKDIR/$name"
+    rm -rf "$bld"
+    if cmake -S "$src" -B "$bld" -DWRAPIT="$WRAPIT" -DWRAPIT_VERBOSITY=0 \
+             -DCMAKE_CXX_COMPILER="$CXX" -DCMAKE_CXX_FLAGS="-ftime-trace" \
+             -DCMAKE_BUILD_TYPE=Release > "$bld.log" 2>&1 \
+        && cmake --build "$bld" -j "$JOBS" >> "$bld.log" 2>&1; then
+        TRACES="$TRACES $name=$bld"
+        echo "$name: built"
+    else
+        echo "$name: build failed, see $bld.log"
+    fi
+}
+
+TRACES=""
+for c in $CASES; do
+    build "$c" "$TESTDIR/$c"
+done
+
+if [ "$NCLASSES" -gt 0 ]; then
+    python3 "$HERE/gen_synthetic.py" -n "$NCLASSES" --n-classes-per-file 10 \
+            --cmake "$(cd "$TESTDIR" && pwd)/WrapitTestSetup.cmake" \
+            -o "$WORKDIR/Synthetic-src"
+    build Synthetic "$WORKDIR/Synthetic-src"
+fi
+
+[ -n "$TRACES" ] || { echo "No case was built." >&2; exit 1; }
+
+# shellcheck disable=SC2086
+python3 "$HERE/aggregate_time_trace.py" -o "$REPORT" \
+        ${BASELINE:+--baseline "$BASELINE"} $TRACES
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Generates a synthetic header file with a large number of classes and the
+wrapit configuration to wrap it. Used to measure how wrapit scales with
+the number of types. See README.md.
+"""
+import argparse
+import os
+
+
+def gen_header(nclasses, nmethods, out):
+    out.write("#ifndef SYNTHETIC_H\n#define SYNTHETIC_H\n\n")
+    out.write("#include <string>\n#include <vector>\n\n")
+    out.write("template<typename T>\nstruct Holder {\n"
+              "  T value;\n  T get() const { return value; }\n"
+              "  void set(const T& v) { value = v; }\n};\n\n")
+    nns = max(1, nclasses // 100)
+    first = [ins * nclasses // nns for ins in range(nns + 1)]
+
+    def qualified(i):
+        ins = next(k for k in range(nns) if first[k] <= i < first[k + 1])
+        return "::ns%d::C%d" % (ins, i)
+
+    # forward declarations, for the references to classes defined later
+    for ins in range(nns):
+        out.write("namespace ns%d {\n" % ins)
+        for i in range(first[ins], first[ins + 1]):
+            out.write("class C%d;\n" % i)
+        out.write("}\n")
+    out.write("\n")
+
+    for ins in range(nns):
+        out.write("namespace ns%d {\n\n" % ins)
+        for i in range(first[ins], first[ins + 1]):
+            # chains of inheritance of depth up to 4
+            parent = ""
+            if i % 4 != 0:
+                parent = " : public %s" % qualified(i - 1)
+            out.write("class C%d%s {\npublic:\n" % (i, parent))
+            out.write("  C%d();\n" % i)
+            out.write("  C%d(int a, double b = 1.);\n" % i)
+            for j in range(nmethods):
+                out.write("  int m%d_%d(int a, const std::string& s = \"\") const;\n" % (i, j))
+            out.write("  double f%d(double x, double y = 0.) const;\n" % i)
+            out.write("  void use(const %s& other);\n" % qualified((i * 7) % nclasses))
+            out.write("  std::vector<double> values();\n")
+            out.write("  int field%d;\n" % i)
+            out.write("};\n\n")
+        out.write("} // namespace ns%d\n\n" % ins)
+    # template instances used as method argument to exercise
+    # the template dependency handling
+    out.write("struct UsesTemplates {\n")
+    for k in range(min(nclasses, 50)):
+        out.write("  void h%d(Holder<%s>& h);\n" % (k, qualified(k)))
+    out.write("};\n\n#endif //SYNTHETIC_H not defined\n")
+
+
+def gen_wit(module_name, n_classes_per_file, out):
+    out.write('module_name         = "%s"\n' % module_name)
+    out.write('uuid                = "0dbcb1fa-4d9b-4b53-a0a2-7c0c6a2e3b10"\n\n')
+    out.write('include_dirs        = [ "." ]\n\n')
+    out.write('input               = [ "Synthetic.h" ]\n\n')
+    out.write('cxx-std             = "c++17"\n\n')
+    out.write('n_classes_per_file  = %d\n\n' % n_classes_per_file)
+    out.write('export              = "all"\n')
+
+
+def gen_cmake(module_name, test_setup, out):
+    out.write("cmake_minimum_required(VERSION 3.12)\n\n")
+    out.write("project(%s)\n\n" % module_name)
+    out.write("set(WRAPPER_EXTRA_SRCS)\n\n")
+    out.write("include(%s)\n" % test_setup)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("-n", "--nclasses", type=int, default=10000,
+                        help="Number of classes to generate (default: 10000)")
+    parser.add_argument("-m", "--nmethods", type=int, default=3,
+                        help="Number of plain methods per class (default: 3)")
+    parser.add_argument("--n-classes-per-file", type=int, default=100,
+                        help="Value of the n_classes_per_file wrapit parameter")
+    parser.add_argument("-o", "--outdir", default="synthetic",
+                        help="Output directory (default: synthetic)")
+    parser.add_argument("--cmake", metavar="TEST_SETUP",
+                        help="Write a CMakeLists.txt to build the wrapper, "
+                        "using the given path to test/WrapitTestSetup.cmake")
+    args = parser.parse_args()
+
+    os.makedirs(args.outdir, exist_ok=True)
+    with open(os.path.join(args.outdir, "Synthetic.h"), "w") as f:
+        gen_header(args.nclasses, args.nmethods, f)
+    with open(os.path.join(args.outdir, "Synthetic.wit"), "w") as f:
+        gen_wit("Synthetic", args.n_classes_per_file, f)
+    if args.cmake:
+        with open(os.path.join(args.outdir, "CMakeLists.txt"), "w") as f:
+            gen_cmake("Synthetic", args.cmake, f)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,104 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Micro-benchmark of the type dependency sort (Graph class), on graphs
+// shaped like the ones of large wrapped libraries. See README.md.
+//
+// Build and run:
+//   g++ -O2 -std=c++17 -I../src graph_sort_bench.cpp ../src/Graph.cpp -o graph_sort_bench
+//   ./graph_sort_bench [NNODES] [NREPEATS]
+//
+#include "Graph.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+  //Deterministic pseudo-random numbers, for reproducible graphs
+  struct Lcg{
+    unsigned long long state = 12345;
+    unsigned operator()(unsigned n){
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      return static_cast<unsigned>((state >> 33) % n);
+    }
+  };
+
+  std::vector<std::string> type_names(unsigned n){
+    std::vector<std::string> names(n);
+    Lcg rnd;
+    for(unsigned i = 0; i < n; ++i){
+      names[i] = "ns" + std::to_string(rnd(100)) + "::Class" + std::to_string(i);
+    }
+    return names;
+  }
+
+  //Single inheritance chain declared in reversed order: the longest
+  //possible dependency path.
+  void chain(Graph& g, unsigned n){
+    for(unsigned i = 1; i < n; ++i) g.preceeds(i, i - 1);
+  }
+
+  //Class hierarchy with template parameter dependencies: each type has
+  //a parent and up to two types used as template parameters.
+  void hierarchy(Graph& g, unsigned n){
+    Lcg rnd;
+    for(unsigned i = 1; i < n; ++i){
+      g.preceeds(rnd(i), i);
+      for(unsigned k = rnd(3); k > 0; --k) g.preceeds(rnd(i), i);
+    }
+  }
+
+  //Hierarchy with 0.1% of reversed dependencies, creating cycles
+  void cyclic(Graph& g, unsigned n){
+    hierarchy(g, n);
+    Lcg rnd;
+    for(unsigned k = 0; k < n / 1000; ++k){
+      unsigned i = 1 + rnd(n - 1);
+      g.preceeds(i, rnd(i));
+    }
+  }
+
+  void run(const char* name, const std::function<void(Graph&, unsigned)>& fill,
+           unsigned n, unsigned nrepeats){
+    const auto& names = type_names(n);
+    double best_ms = 1.e30;
+    double sum_ms = 0;
+    size_t ncycles = 0;
+    for(unsigned r = 0; r < nrepeats; ++r){
+      Graph g;
+      fill(g, n);
+      g.extend(n);
+      g.setKeys(names);
+      auto t0 = std::chrono::steady_clock::now();
+      auto sorted = g.sortedIndices();
+      ncycles = g.cycles().size();
+      auto t1 = std::chrono::steady_clock::now();
+      if(sorted.size() != n){
+        std::fprintf(stderr, "%s: %zu sorted nodes instead of %u.\n", name,
+                     sorted.size(), n);
+        std::exit(1);
+      }
+      double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+      best_ms = std::min(best_ms, ms);
+      sum_ms += ms;
+    }
+    std::printf("%-12s %10u %10zu %12.2f %12.2f\n", name, n, ncycles,
+                best_ms, sum_ms / nrepeats);
+  }
+}
+
+int main(int argc, char* argv[]){
+  unsigned n = argc > 1 ? std::atoi(argv[1]) : 100000;
+  unsigned nrepeats = argc > 2 ? std::atoi(argv[2]) : 10;
+
+  std::printf("%-12s %10s %10s %12s %12s\n", "graph", "nodes", "cycles",
+              "best (ms)", "mean (ms)");
+  run("chain", chain, n, nrepeats);
+  run("hierarchy", hierarchy, n, nrepeats);
+  run("cyclic", cyclic, n, nrepeats);
+  return 0;
+}
@@ -0,0 +1,61 @@
+#!/bin/sh
+#
+# Compares the number of lambda functions generated for the methods by the
+# two method wrapper strategies. wrapit is run on each configuration file
+# of the test directory with method_wrapper_strategy = "lambdas" and
+# "ptr_adapter", and the "Number of lambda functions generated" line of
+# the two reports is printed.
+#
+# Usage: lambda_count.sh [WIT ...]
+#
+# WIT ...: configuration files (default: all the test/Test*/*.wit files)
+#
+# Environment variables:
+#   WRAPIT: path to the wrapit executable (default: wrapit found in PATH)
+#   WORKDIR: directory for the generated code (default: ./lambda-count-bench)
+#
+set -e
+
+HERE="$(cd "$(dirname "$0")" && pwd)"
+
+WRAPIT="${WRAPIT:-$(command -v wrapit || true)}"
+[ -n "$WRAPIT" ] || { echo "wrapit executable not found. Set WRAPIT." >&2; exit 1; }
+WORKDIR="${WORKDIR:-$PWD/lambda-count-bench}"
+
+if [ $# -gt 0 ]; then
+    WITS="$*"
+else
+    WITS="$(ls "$HERE"/../test/Test*/*.wit)"
+fi
+
+# Number of lambdas of the report of a wrapit run, "failed" if wrapit failed
+count(){
+    wit="$1"; strategy="$2"; out="$3"
+    rm -rf "$out"
+    if ( cd "$(dirname "$wit")" \
+             && "$WRAPIT" --force --add-cfg "method_wrapper_strategy=\"$strategy\"" \
+                          --output-prefix "$out" "$(basename "$wit")" ) \
+           > "$out.log" 2>&1; then
+        sed -n 's/^Number of lambda functions generated for the methods.*: \([0-9]*\)$/\1/p' \
+            "$out"/jl*-report.txt 2>/dev/null || echo failed
+    else
+        echo failed
+    fi
+}
+
+mkdir -p "$WORKDIR"
+printf "%-40s %10s %12s\n" "configuration" "lambdas" "ptr_adapter"
+total_l=0
+total_p=0
+for wit in $WITS; do
+    name="$(basename "$(dirname "$wit")")/$(basename "$wit" .wit)"
+    out="$WORKDIR/$(echo "$name" | tr / _)"
+    l="$(count "$wit" lambdas "$out-lambdas")"
+    p="$(count "$wit" ptr_adapter "$out-ptr_adapter")"
+    printf "%-40s %10s %12s\n" "$name" "$l" "$p"
+    if [ "$l" != failed ] && [ "$p" != failed ]; then
+        total_l=$((total_l + l))
+        total_p=$((total_p + p))
+    fi
+done
+printf "%-40s %10d %12d\n" "total (successful runs)" "$total_l" "$total_p"
@@ -0,0 +1,188 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Micro-benchmark of the lookups done by wrapit for each visited
+// declaration, on a header produced by gen_synthetic.py. See README.md.
+//
+// Build and run:
+//   g++ -O2 -std=c++17 -I../src lookup_bench.cpp ../src/CursorIndex.cpp -lclang -o lookup_bench
+//   ./lookup_bench synthetic/Synthetic.h [NREPEATS]
+//
+#include "CursorIndex.h"
+
+#include <clang-c/Index.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+//Defined in utils.cpp for wrapit, which is not linked here.
+std::string str(const CXString& x){
+  const char* c = clang_getCString(x);
+  std::string r = c ? c : "";
+  clang_disposeString(x);
+  return r;
+}
+
+namespace {
+  std::string main_file;
+  std::unordered_map<CXFile, bool> main_file_cache;
+  bool use_main_file_cache = true;
+
+  //Re-implementation of the check of CodeTree::fromMainFiles() for a
+  //single input header, with the decision cached per CXFile or, as before
+  //this cache, the path of the cursor file resolved for each call.
+  bool from_main_file(const CXCursor& cursor){
+    CXFile file;
+    clang_getFileLocation(clang_getCursorLocation(cursor), &file,
+                          nullptr, nullptr, nullptr);
+    if(!use_main_file_cache){
+      return fs::canonical(fs::path(str(clang_getFileName(file)))).string() == main_file;
+    }
+    auto it = main_file_cache.find(file);
+    if(it == main_file_cache.end()){
+      auto fname = fs::canonical(fs::path(str(clang_getFileName(file)))).string();
+      it = main_file_cache.emplace(file, fname == main_file).first;
+    }
+    return it->second;
+  }
+
+  //Classes and class members of the main file
+  std::vector<CXCursor> classes;
+  std::vector<CXCursor> members;
+
+  CXChildVisitResult collect(CXCursor cursor, CXCursor, CXClientData){
+    if(!from_main_file(cursor)) return CXChildVisit_Continue;
+    const auto kind = clang_getCursorKind(cursor);
+    if(kind == CXCursor_Namespace) return CXChildVisit_Recurse;
+    if((kind == CXCursor_ClassDecl || kind == CXCursor_StructDecl)
+       && clang_isCursorDefinition(cursor)){
+      classes.push_back(cursor);
+      clang_visitChildren(cursor, collect, nullptr);
+    } else if(kind == CXCursor_CXXMethod || kind == CXCursor_Constructor
+              || kind == CXCursor_FieldDecl){
+      members.push_back(cursor);
+    }
+    return CXChildVisit_Continue;
+  }
+
+  //Simplified AST traversal of CodeTree::visit(), without the processing
+  //of the declarations: the main file check is done for
+  //each visited cursor, the namespaces and the classes of the main file
+  //are recursed into.
+  unsigned long nvisited = 0;
+  CXChildVisitResult visit(CXCursor cursor, CXCursor, CXClientData){
+    ++nvisited;
+    if(!from_main_file(cursor)) return CXChildVisit_Continue;
+    const auto kind = clang_getCursorKind(cursor);
+    if(kind == CXCursor_Namespace) return CXChildVisit_Recurse;
+    if(kind == CXCursor_ClassDecl || kind == CXCursor_StructDecl){
+      clang_visitChildren(cursor, visit, nullptr);
+    }
+    return CXChildVisit_Continue;
+  }
+
+  double now_ms(){
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()
+                                                     .time_since_epoch()).count();
+  }
+
+  //Type registry lookups: each class is looked up before being
+  //registered, and the class of each member is looked up, as done by
+  //add_type() and find_class_of_method(). The registry is either
+  //scanned with clang_equalCursors, as before the CursorIndex, or
+  //looked up with a CursorIndex.
+  double registry(bool indexed, unsigned& nfound){
+    auto t0 = now_ms();
+    std::vector<CXCursor> types;
+    CursorIndex index;
+    auto find = [&](const CXCursor& c) -> int {
+      if(indexed) return index.find(c);
+      for(unsigned i = 0; i < types.size(); ++i){
+        if(clang_equalCursors(types[i], c)) return i;
+      }
+      return -1;
+    };
+    for(const auto& c: classes){
+      if(find(c) < 0){
+        index.add(c, types.size());
+        types.push_back(c);
+      }
+    }
+    nfound = 0;
+    for(const auto& m: members){
+      if(find(clang_getCursorSemanticParent(m)) >= 0) ++nfound;
+    }
+    return now_ms() - t0;
+  }
+
+  double traversal(const CXCursor& tu_cursor, bool cached){
+    use_main_file_cache = cached;
+    main_file_cache.clear();
+    nvisited = 0;
+    auto t0 = now_ms();
+    clang_visitChildren(tu_cursor, visit, nullptr);
+    auto dt = now_ms() - t0;
+    use_main_file_cache = true;
+    return dt;
+  }
+
+  template<typename F>
+  double best_of(unsigned nrepeats, F f){
+    double best = 1.e30;
+    for(unsigned r = 0; r < nrepeats; ++r) best = std::min(best, f());
+    return best;
+  }
+}
+
+int main(int argc, char* argv[]){
+  if(argc < 2){
+    std::fprintf(stderr, "Usage: lookup_bench HEADER [NREPEATS]\n");
+    return 1;
+  }
+  main_file = fs::canonical(argv[1]).string();
+  unsigned nrepeats = argc > 2 ? std::atoi(argv[2]) : 3;
+
+  const char* opts[] = { "-x", "c++", "-std=c++17" };
+  CXIndex index = clang_createIndex(0, 0);
+  CXTranslationUnit unit = clang_parseTranslationUnit(index, argv[1], opts, 3,
+                                                      nullptr, 0,
+                                                      CXTranslationUnit_SkipFunctionBodies);
+  if(!unit){
+    std::fprintf(stderr, "Failed to parse %s\n", argv[1]);
+    return 1;
+  }
+  const auto& tu_cursor = clang_getTranslationUnitCursor(unit);
+
+  clang_visitChildren(tu_cursor, collect, nullptr);
+
+  unsigned nfound_linear = 0;
+  unsigned nfound_indexed = 0;
+  double linear_ms = best_of(nrepeats, [&]{ return registry(false, nfound_linear); });
+  double indexed_ms = best_of(nrepeats, [&]{ return registry(true, nfound_indexed); });
+  if(nfound_linear != nfound_indexed){
+    std::fprintf(stderr, "Inconsistent lookup results: %u != %u\n",
+                 nfound_linear, nfound_indexed);
+    return 1;
+  }
+
+  double uncached_ms = best_of(nrepeats, [&]{ return traversal(tu_cursor, false); });
+  double cached_ms = best_of(nrepeats, [&]{ return traversal(tu_cursor, true); });
+
+  std::printf("%zu classes, %zu members, %lu visited cursors\n", classes.size(),
+              members.size(), nvisited);
+  std::printf("%-40s %10.1f ms\n", "type registry, linear scans:", linear_ms);
+  std::printf("%-40s %10.1f ms\n", "type registry, CursorIndex:", indexed_ms);
+  std::printf("%-40s %10.1f ms\n", "visit, file path per cursor:", uncached_ms);
+  std::printf("%-40s %10.1f ms\n", "visit, main file check per CXFile:", cached_ms);
+
+  clang_disposeTranslationUnit(unit);
+  clang_disposeIndex(index);
+  return 0;
+}
@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Measures wrapit execution time as a function of the number of classes
+# of the wrapped header, using synthetic headers produced by gen_synthetic.py.
+#
+# Usage: run_synthetic.sh [WRAPIT] [N1 N2 ...]
+#
+# WRAPIT: path to the wrapit executable (default: wrapit found in PATH)
+# N1 N2 ...: numbers of classes (default: 1000 2500 5000 10000)
+#
+set -e
+
+WRAPIT="${1:-wrapit}"
+[ $# -gt 0 ] && shift
+SIZES="${*:-1000 2500 5000 10000}"
+
+HERE="$(cd "$(dirname "$0")" && pwd)"
+WORKDIR="${WORKDIR:-$PWD/synthetic-bench}"
+
+printf "%10s %12s\n" "nclasses" "time (s)"
+for n in $SIZES; do
+    dir="$WORKDIR/n$n"
+    python3 "$HERE/gen_synthetic.py" -n "$n" -o "$dir"
+    start=$(date +%s.%N)
+    ( cd "$dir" && "$WRAPIT" --force Synthetic.wit > wrapit.log 2>&1 )
+    end=$(date +%s.%N)
+    printf "%10d %12.2f\n" "$n" "$(echo "$end - $start" | bc)"
+done
@@ -0,0 +1,113 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#include "BufferedFile.h"
+
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern int verbose;
+
+namespace {
+  //Position after the first n lines of the buffer [p, p + size)
+  size_t skip_lines(const char* p, size_t size, int n){
+    size_t pos = 0;
+    for(int i = 0; i < n && pos < size; ++i){
+      const void* eol = memchr(p + pos, '\n', size - pos);
+      pos = eol ? (static_cast<const char*>(eol) - p) + 1 : size;
+    }
+    return pos;
+  }
+}
+
+BufferedFile::BufferedFile(const std::string& path, bool only_if_changed,
+                           int nskiplines):
+  path_(path), only_if_changed_(only_if_changed), nskiplines_(nskiplines),
+  closed_(path.empty()), written_(false){
+}
+
+BufferedFile::BufferedFile(BufferedFile&& other):
+  std::ostringstream(std::move(other)),
+  path_(std::move(other.path_)), only_if_changed_(other.only_if_changed_),
+  nskiplines_(other.nskiplines_), closed_(other.closed_),
+  written_(other.written_){
+  other.closed_ = true;
+}
+
+BufferedFile& BufferedFile::operator=(BufferedFile&& other){
+  close();
+  std::ostringstream::operator=(std::move(other));
+  path_ = std::move(other.path_);
+  only_if_changed_ = other.only_if_changed_;
+  nskiplines_ = other.nskiplines_;
+  closed_ = other.closed_;
+  written_ = other.written_;
+  other.closed_ = true;
+  return *this;
+}
+
+BufferedFile::~BufferedFile(){
+  close();
+}
+
+bool BufferedFile::same_as_file(const std::string& contents) const{
+  int fd = open(path_.c_str(), O_RDONLY);
+  if(fd < 0) return false;
+
+  struct stat st;
+  bool same = false;
+  if(fstat(fd, &st) == 0){
+    const size_t size = st.st_size;
+    if(nskiplines_ == 0 && size != contents.size()){
+      same = false;
+    } else if(size == 0){
+      same = contents.empty();
+    } else{
+      void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(p != MAP_FAILED){
+        const char* old = static_cast<const char*>(p);
+        const size_t pos_old = skip_lines(old, size, nskiplines_);
+        const size_t pos_new = skip_lines(contents.data(), contents.size(), nskiplines_);
+        same = (size - pos_old == contents.size() - pos_new)
+          && memcmp(old + pos_old, contents.data() + pos_new, size - pos_old) == 0;
+        munmap(p, size);
+      }
+    }
+  }
+  ::close(fd);
+  return same;
+}
+
+bool BufferedFile::close(){
+  if(closed_) return true;
+  closed_ = true;
+  written_ = false;
+
+  const std::string& contents = str();
+
+  if(only_if_changed_ && same_as_file(contents)){
+    if(verbose > 4){
+      std::cerr << "Code in file " << path_
+                << " did not change, the file is not rewritten.\n";
+    }
+    return true;
+  }
+
+  std::ofstream f(path_, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+  f.write(contents.data(), contents.size());
+  f.close();
+  if(f.fail()){
+    std::cerr << "Error: failed to write file " << path_ << ".\n";
+    return false;
+  }
+  written_ = true;
+  return true;
+}
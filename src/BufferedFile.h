@@ -0,0 +1,51 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#ifndef BUFFEREDFILE_H
+#define BUFFEREDFILE_H
+
+#include <sstream>
+#include <string>
+
+// Output file whose contents are generated in memory and written on
+// close(), or on destruction, only if they differ from the existing file.
+// An unchanged file is therefore not rewritten and keeps its time stamp,
+// which prevents spurious recompilations.
+//
+// The comparison ignores the first nskiplines lines, e.g. a header line
+// with the version of the generator. With only_if_changed set to false,
+// the file is always written.
+class BufferedFile: public std::ostringstream{
+public:
+  explicit BufferedFile(const std::string& path = std::string(),
+                        bool only_if_changed = true, int nskiplines = 0);
+
+  BufferedFile(BufferedFile&& other);
+  BufferedFile& operator=(BufferedFile&& other);
+
+  ~BufferedFile();
+
+  //Writes the file if needed. Returns false if writing failed.
+  bool close();
+
+  //Closes the file without writing it
+  void discard() { closed_ = true; }
+
+  //Tells if the last close() wrote the file
+  bool written() const { return written_; }
+
+private:
+  //Checks if the file contents, excluding the first nskiplines_ lines,
+  //are identical to contents
+  bool same_as_file(const std::string& contents) const;
+
+  std::string path_;
+  bool only_if_changed_;
+  int nskiplines_;
+  bool closed_;
+  bool written_;
+};
+
+#endif //BUFFEREDFILE_H not defined
@@ -0,0 +1,259 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#include "BuildTester.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <deque>
+#include <algorithm>
+#include <filesystem>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#include "utils.h"
+
+namespace fs = std::filesystem;
+
+extern int verbose;
+
+namespace {
+  void replace_all(std::string& s, const std::string& from, const std::string& to){
+    for(auto pos = s.find(from); pos != std::string::npos;
+        pos = s.find(from, pos + to.size())){
+      s.replace(pos, from.size(), to);
+    }
+  }
+}
+
+BuildTester::BuildTester(const std::string& workdir, const std::string& build_cmd):
+  workdir_(workdir), build_cmd_(build_cmd), njobs_(1), ncompilations_(0){
+}
+
+std::string BuildTester::command(const std::string& src, const std::string& obj) const{
+  std::string cmd = build_cmd_;
+  if(cmd.find("{src}") == std::string::npos && cmd.find("{obj}") == std::string::npos){
+    cmd += " -c {src} -o {obj}";
+  }
+  replace_all(cmd, "{src}", src);
+  replace_all(cmd, "{obj}", obj);
+  return cmd;
+}
+
+bool BuildTester::prepare(){
+  std::error_code ec;
+  fs::create_directories(workdir_, ec);
+
+  prefix_path_ = join_paths(workdir_, "prefix.h");
+  std::ofstream f(prefix_path_);
+  f << "// this file was auto-generated by wrapit for the test_build mode\n"
+    << prefix_;
+  f.close();
+  if(f.fail()){
+    std::cerr << "Error: failed to write file " << prefix_path_ << ".\n";
+    return false;
+  }
+
+  //Precompilation of the header. It is an optimization, the tests
+  //still run if it fails, e.g. when the compiler does not pick
+  //precompiled headers by the .gch suffix.
+  const auto& gch = prefix_path_ + ".gch";
+  const auto& log = join_paths(workdir_, "prefix.log");
+  fs::remove(gch, ec);
+  auto ok = run({command("-x c++-header " + prefix_path_, gch)}, {log});
+  if(ok[0]){
+    fs::remove(log, ec);
+  } else{
+    fs::remove(gch, ec);
+    std::cerr << "Warning: precompilation of the test build prefix header failed. "
+      "See " << log << ".\n";
+  }
+
+  //Compilation of an empty batch: if it fails, build_cmd or the prefix
+  //is broken and all the batches would fail
+  const auto& base = join_paths(workdir_, "test_empty");
+  if(!write_batch(base + ".cxx", {})){
+    std::cerr << "Error: failed to write file " << base << ".cxx.\n";
+    return false;
+  }
+  ok = run({command(base + ".cxx", base + ".o")}, {base + ".log"});
+  fs::remove(base + ".o", ec);
+  if(!ok[0]){
+    std::cerr << "Error: the compilation of the test build prefix header alone "
+      "fails. Check the build_cmd configuration parameter. See " << base << ".log.\n";
+    return false;
+  }
+  fs::remove(base + ".cxx", ec);
+  fs::remove(base + ".log", ec);
+
+  return true;
+}
+
+bool BuildTester::write_batch(const std::string& path,
+                              const std::vector<unsigned>& batch) const{
+  std::ofstream f(path);
+  f << "#include \"" << prefix_path_ << "\"\n";
+
+  std::set<std::string> types;
+  for(auto i: batch){
+    const auto& type = blocks_[i].type;
+    if(!types.insert(type).second) continue;
+    auto it = preambles_.find(type);
+    if(it != preambles_.end()) f << it->second;
+  }
+
+  for(auto i: batch){
+    const auto& b = blocks_[i];
+    f << "\n// " << b.signature << "\n";
+    f << "void wrapit_test_build_" << i << "(jlcxx::Module& module_, ";
+    if(b.type.size() > 0){
+      f << "jlcxx::TypeWrapper<" << b.type << ">& t";
+    } else{
+      f << "jlcxx::Module& t";
+    }
+    f << "){\n" << b.code << "}\n";
+  }
+  f.close();
+  return !f.fail();
+}
+
+std::vector<bool>
+BuildTester::run(const std::vector<std::string>& commands,
+                 const std::vector<std::string>& logs){
+  std::vector<bool> results(commands.size(), false);
+  std::map<pid_t, unsigned> running;
+  unsigned next = 0;
+
+  std::cout.flush();
+  std::cerr.flush();
+
+  while(next < commands.size() || running.size() > 0){
+    while(running.size() < njobs_ && next < commands.size()){
+      if(verbose > 1) std::cerr << "Info: running " << commands[next] << "\n";
+      pid_t pid = fork();
+      if(pid == 0){
+        int fd = open(logs[next].c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(fd >= 0){
+          dup2(fd, 1);
+          dup2(fd, 2);
+          close(fd);
+        }
+        execl("/bin/sh", "sh", "-c", commands[next].c_str(), (char*) nullptr);
+        _exit(127);
+      } else if(pid < 0){
+        std::cerr << "Error: failed to start a build process.\n";
+        results[next] = false;
+      } else{
+        running[pid] = next;
+        ++ncompilations_;
+      }
+      ++next;
+    }
+
+    if(running.empty()) continue;
+
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    if(pid < 0) break;
+    auto it = running.find(pid);
+    if(it == running.end()) continue;
+    results[it->second] = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    running.erase(it);
+  }
+
+  return results;
+}
+
+bool
+BuildTester::failing_blocks(const std::vector<std::vector<unsigned>>& batches,
+                            std::vector<unsigned>& failures){
+  failures.clear();
+  std::deque<std::vector<unsigned>> todo(batches.begin(), batches.end());
+  unsigned itest = 0;
+
+  //A round compiles up to njobs_ batches in parallel. The failing batches
+  //are split in two halves for the next rounds.
+  while(!todo.empty()){
+    std::vector<std::vector<unsigned>> round;
+    while(!todo.empty() && round.size() < njobs_){
+      if(todo.front().size() > 0) round.push_back(todo.front());
+      todo.pop_front();
+    }
+
+    std::vector<std::string> commands, logs, srcs, objs;
+    for(const auto& batch: round){
+      std::string base = join_paths(workdir_, "test_" + std::to_string(itest++));
+      srcs.push_back(base + ".cxx");
+      objs.push_back(base + ".o");
+      logs.push_back(base + ".log");
+      if(!write_batch(srcs.back(), batch)){
+        std::cerr << "Error: failed to write file " << srcs.back() << ".\n";
+        return false;
+      }
+      commands.push_back(command(srcs.back(), objs.back()));
+    }
+
+    const auto& results = run(commands, logs);
+
+    for(unsigned j = 0; j < round.size(); ++j){
+      std::error_code ec;
+      fs::remove(objs[j], ec);
+      if(results[j]){
+        fs::remove(srcs[j], ec);
+        fs::remove(logs[j], ec);
+        continue;
+      }
+
+      const auto& batch = round[j];
+      if(verbose > 0){
+        std::cerr << "Info: test build of " << batch.size() << " wrapper"
+                  << (batch.size() > 1 ? "s" : "") << " failed (" << srcs[j] << ").\n";
+      }
+      if(batch.size() == 1){
+        failures.push_back(batch[0]);
+        logs_[batch[0]] = logs[j];
+      } else{
+        fs::remove(srcs[j], ec);
+        fs::remove(logs[j], ec);
+        auto mid = batch.begin() + batch.size() / 2;
+        //depth first, to report failures in order:
+        todo.emplace_front(mid, batch.end());
+        todo.emplace_front(batch.begin(), mid);
+      }
+    }
+  }
+
+  std::sort(failures.begin(), failures.end());
+  return true;
+}
+
+std::vector<bool>
+BuildTester::compile_files(const std::vector<std::string>& paths){
+  std::vector<std::string> commands, logs, objs;
+  for(const auto& p: paths){
+    auto base = join_paths(workdir_, fs::path(p).stem().string());
+    objs.push_back(base + ".o");
+    logs.push_back(base + ".log");
+    commands.push_back(command(p, objs.back()));
+  }
+
+  const auto& results = run(commands, logs);
+
+  for(unsigned j = 0; j < paths.size(); ++j){
+    std::error_code ec;
+    fs::remove(objs[j], ec);
+    if(results[j]) fs::remove(logs[j], ec);
+  }
+  return results;
+}
+
+std::string BuildTester::log_path(unsigned i) const{
+  auto it = logs_.find(i);
+  return it == logs_.end() ? std::string() : it->second;
+}
@@ -0,0 +1,105 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#ifndef BUILDTESTER_H
+#define BUILDTESTER_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+// Compilation test of the generated code (test_build mode).
+//
+// The code generated for each wrapped function (a "block") is recorded
+// and compiled separately from the rest of the module: a batch of blocks
+// is put in a small source file, which includes a precompiled prefix
+// header and the jlcxx trait specializations of the types it uses. Each
+// block is embedded in a function that receives the jlcxx module and the
+// type wrapper it refers to. Failing batches are bisected down to the
+// blocks responsible for the failure. Compilations run in parallel
+// processes.
+//
+// The compilation command is build_cmd, where the {src} and {obj}
+// placeholders are substituted with the source and object file paths.
+// If the command contains no placeholder, "-c {src} -o {obj}" is
+// appended to it.
+class BuildTester{
+public:
+  struct Block{
+    //signature of the wrapped entity, in the veto file format
+    std::string signature;
+    //parameter of the jlcxx::TypeWrapper the code is applied to,
+    //empty for global functions and variables (jlcxx::Module)
+    std::string type;
+    //generated code
+    std::string code;
+    //file the code was written in
+    std::string file;
+  };
+
+  BuildTester(const std::string& workdir, const std::string& build_cmd);
+
+  //Sets the code of the prefix header, common to all the tests
+  void set_prefix(const std::string& code){ prefix_ = code; }
+
+  //Sets the code, jlcxx trait specializations, that must precede the
+  //blocks related to a given type.
+  void add_preamble(const std::string& type, const std::string& code){
+    preambles_[type] = code;
+  }
+
+  void add_block(const Block& b){ blocks_.push_back(b); }
+
+  const std::vector<Block>& blocks() const { return blocks_; }
+
+  //Maximal number of compilations to run in parallel
+  void set_njobs(unsigned n){ njobs_ = n > 0 ? n : 1; }
+
+  //Writes the prefix header, tries to precompile it, and checks that a
+  //source including only this header compiles. Returns false if the
+  //header could not be written or the check failed.
+  bool prepare();
+
+  //Compiles the batches of blocks (indices in blocks()), bisects the
+  //failing ones and sets failures to the indices of the blocks failing to
+  //compile, in increasing order. Returns false if a test source file
+  //could not be written.
+  bool failing_blocks(const std::vector<std::vector<unsigned>>& batches,
+                      std::vector<unsigned>& failures);
+
+  //Compiles the given source files, each one on its own. Returns the
+  //success status of each compilation.
+  std::vector<bool> compile_files(const std::vector<std::string>& paths);
+
+  //Path of the compilation log of the last failed compilation of
+  //block i, empty if none.
+  std::string log_path(unsigned i) const;
+
+  //Number of compilations performed so far
+  unsigned ncompilations() const { return ncompilations_; }
+
+private:
+  std::string command(const std::string& src, const std::string& obj) const;
+
+  //Runs the commands with up to njobs_ concurrent processes and returns
+  //their success statuses. The output of command i is sent to logs[i].
+  std::vector<bool> run(const std::vector<std::string>& commands,
+                        const std::vector<std::string>& logs);
+
+  //Writes the test source file for a batch of blocks
+  bool write_batch(const std::string& path, const std::vector<unsigned>& batch) const;
+
+  std::string workdir_;
+  std::string build_cmd_;
+  std::string prefix_;
+  std::string prefix_path_;
+  std::map<std::string, std::string> preambles_;
+  std::vector<Block> blocks_;
+  std::map<unsigned, std::string> logs_;
+  unsigned njobs_;
+  unsigned ncompilations_;
+};
+
+#endif //BUILDTESTER_H not defined
@@ -18,8 +18,9 @@
 #include "stdio.h"
 
 #include "FunctionWrapper.h"
+#include "Profiler.h"
 #include "libclang-ext.h"
-#include "FileTimeRestorer.h"
+#include "BufferedFile.h"
 #include "utils.h"
 #include "cxxwrap_version.h"
 
@@ -31,6 +32,13 @@ extern const char* version;
 #include "clang/AST/DeclTemplate.h"
 
 #include <dlfcn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 //The general strategy for class wrapper declaration is to first declare all
 //classes (add_type() calls) and in a second step declare the wrapper for
@@ -70,6 +78,50 @@ namespace{
       std::cerr << location <<  ": " << text << "\n";
     }
   }
+
+  //Size and modification time of a file, used to validate
+  //the cached AST. Returns false if the file cannot be accessed.
+  bool file_stamp(const std::string& path, uintmax_t& size, long long& mtime){
+    std::error_code ec;
+    size = fs::file_size(path, ec);
+    if(ec) return false;
+    mtime = fs::last_write_time(path, ec).time_since_epoch().count();
+    return !ec;
+  }
+
+  //Length-prefixed string (de)serialization used to pass the code
+  //generation bookkeeping from the worker processes back to the parent.
+  void write_str(std::ostream& o, const std::string& s){
+    o << s.size() << " " << s << "\n";
+  }
+
+  std::string read_str(std::istream& i){
+    size_t n = 0;
+    i >> n;
+    i.get();
+    std::string s(n, '\0');
+    i.read(s.data(), n);
+    i.get();
+    return s;
+  }
+
+  template<typename C>
+  void write_strs(std::ostream& o, const C& c, size_t from = 0){
+    o << (c.size() > from ? c.size() - from : 0) << "\n";
+    size_t j = 0;
+    for(const auto& s: c){
+      if(j++ >= from) write_str(o, s);
+    }
+  }
+
+  std::vector<std::string> read_strs(std::istream& i){
+    size_t n = 0;
+    i >> n;
+    std::vector<std::string> v;
+    v.reserve(n);
+    for(size_t j = 0; j < n; ++j) v.emplace_back(read_str(i));
+    return v;
+  }
 }
 
 using namespace codetree;
@@ -114,15 +166,8 @@ CodeTree::getParentClassesForWrapper(CXCursor cursor) const{
       const auto& inheritance_access = clang_getCXXAccessSpecifier(cursor);
       const auto& t1 = clang_getCursorType(cursor);
       if(inheritance_access == CX_CXXPublic){
-        bool isBaseWrapped = false;
-        for(const auto& c: tree.types_){
-          //FIXME: support for templates
-          const auto& t2 = clang_getCursorType(c.cursor);
-          if(same_type(t1, t2)){
-            isBaseWrapped = true;
-            break;
-          }
-        }
+        //FIXME: support for templates
+        bool isBaseWrapped = tree.find_type_index(t1) >= 0;
 
         if(str(clang_getTypeSpelling(t1)) == "std::string"){
           isBaseWrapped = true;
@@ -315,14 +360,19 @@ std::ostream&
 CodeTree::generate_cxx_for_type(std::ostream& o,
                                 const TypeRcd& t){
 
+  Profiler::Scope prof("type", t.type_name.size() > 0 ? t.type_name : "<global functions>");
+
   //if true, fake type used to hold global functions
   bool notype = t.type_name.size() == 0;
 
   bool no_copy_ctor = find(copy_ctor_to_veto_.begin(),
                            copy_ctor_to_veto_.end(), t.type_name) != copy_ctor_to_veto_.end();
 
+  //jlcxx trait specializations, kept aside for the test_build mode
+  std::stringstream preamble;
+
   if(!notype){
-    o << "\nnamespace jlcxx {\n";
+    preamble << "\nnamespace jlcxx {\n";
     //generate code that disables mirrored type
     if(verbose > 2) std::cerr << "Disable mirrored type for type " << t.type_name << "\n";
     if(t.template_parameter_combinations.size() > 0){
@@ -333,33 +383,33 @@ CodeTree::generate_cxx_for_type(std::ostream& o,
       }
       auto param_list1 = join(param_list, ", ");
       auto param_list2 = join(t.template_parameters, ", ");
-      o << "\n";
-      indent(o, 1) << "template<" << param_list1 << ">\n";
-      indent(o, 1) << "struct BuildParameterList<" << t.type_name << "<" << param_list2 << ">>\n";
-      indent(o, 1) << "{\n";
-      indent(o, 2) << "typedef ParameterList<";
+      preamble << "\n";
+      indent(preamble, 1) << "template<" << param_list1 << ">\n";
+      indent(preamble, 1) << "struct BuildParameterList<" << t.type_name << "<" << param_list2 << ">>\n";
+      indent(preamble, 1) << "{\n";
+      indent(preamble, 2) << "typedef ParameterList<";
       const char* sep = "";
       for(decltype(nparams) i = 0; i < nparams; ++i){
         if (t.template_parameter_types[i] != "typename") {
-          o << sep << "std::integral_constant<" << t.template_parameter_types[i] << ", " << t.template_parameters[i] << ">";
+          preamble << sep << "std::integral_constant<" << t.template_parameter_types[i] << ", " << t.template_parameters[i] << ">";
           sep = ", ";
         } else {
-          o << sep << t.template_parameters[i];
+          preamble << sep << t.template_parameters[i];
           sep = ", ";
         }
       }
-      o << "> type;\n";
-      indent(o,1) << "};\n\n";
-      indent(o, 1) << "template<" << param_list1 << "> struct IsMirroredType<" << t.type_name << "<" << param_list2 << ">> : std::false_type { };\n";
-      indent(o, 1) << "template<" << param_list1 << "> struct DefaultConstructible<" << t.type_name << "<" << param_list2 << ">> : std::false_type { };\n";
+      preamble << "> type;\n";
+      indent(preamble,1) << "};\n\n";
+      indent(preamble, 1) << "template<" << param_list1 << "> struct IsMirroredType<" << t.type_name << "<" << param_list2 << ">> : std::false_type { };\n";
+      indent(preamble, 1) << "template<" << param_list1 << "> struct DefaultConstructible<" << t.type_name << "<" << param_list2 << ">> : std::false_type { };\n";
       if(no_copy_ctor){
-        indent(o, 1) << "template<" << param_list1 << "> struct CopyConstructible<" << t.type_name << "<" << param_list2 << ">> : std::false_type { };\n";
+        indent(preamble, 1) << "template<" << param_list1 << "> struct CopyConstructible<" << t.type_name << "<" << param_list2 << ">> : std::false_type { };\n";
       }
     } else{
-      indent(o, 1) << "template<> struct IsMirroredType<" << t.type_name << "> : std::false_type { };\n";
-      indent(o, 1) << "template<> struct DefaultConstructible<" << t.type_name << "> : std::false_type { };\n";
+      indent(preamble, 1) << "template<> struct IsMirroredType<" << t.type_name << "> : std::false_type { };\n";
+      indent(preamble, 1) << "template<> struct DefaultConstructible<" << t.type_name << "> : std::false_type { };\n";
       if(no_copy_ctor){
-        indent(o, 1) << "template<> struct CopyConstructible<" << t.type_name << "> : std::false_type { };\n";
+        indent(preamble, 1) << "template<> struct CopyConstructible<" << t.type_name << "> : std::false_type { };\n";
       }
     }
 
@@ -381,14 +431,17 @@ CodeTree::generate_cxx_for_type(std::ostream& o,
                     << ", " << __FILE__ << ":" << __LINE__ << "].\n";
         }
       } else{
-        indent(o, 1) << "template<> struct SuperType<"
+        indent(preamble, 1) << "template<> struct SuperType<"
                      << t.type_name
                      << "> { typedef " << fully_qualified_name(base) << " type; };\n";
       }
     }
-      o << "}\n\n";
+      preamble << "}\n\n";
   }
 
+  o << preamble.str();
+  if(build_tester_ && !notype) build_tester_->add_preamble(t.type_name, preamble.str());
+
   std::string wrapper = wrapper_classsname(t.type_name);
 
   o << "// Class generating the wrapper for type " << t.type_name << "\n"
@@ -418,6 +471,17 @@ CodeTree::generate_cxx_for_type(std::ostream& o,
   bool add_method_body_moved_to_ctor = false;
 #endif
 
+  //code of the add_lazy_methods method, lazy_method_registration mode
+  std::stringstream lazy;
+  if(lazy_method_registration_ && !add_method_body_moved_to_ctor
+     && (notype || clang_getCursorKind(t.cursor) != CXCursor_ClassTemplate)){
+    lazy_o_ = &lazy;
+    lazy_group_ = wrapper;
+    if(lib_split_ != lib_split_t::none){
+      lazy_o_file_ = lib_group_filename(current_cxx_file_, lib_group(t, current_cxx_file_));
+    }
+  }
+
   //add_methods method
   indent(o, 1) << "void add_methods() const{\n";
   if(!add_method_body_moved_to_ctor){
@@ -478,7 +542,8 @@ CodeTree::generate_cxx_for_type(std::ostream& o,
                           << " because its type is anonymous.\n";
               }
             } else{
-              generate_accessor_cxx(o, &t, f, accessor_gen == accessor_mode_t::getter, 2);
+              generate_accessor_cxx(lazy_o_ ? *lazy_o_ : o, &t, f,
+                                    accessor_gen == accessor_mode_t::getter, 2);
             }
           }
         }
@@ -491,6 +556,41 @@ CodeTree::generate_cxx_for_type(std::ostream& o,
   }  //!add_method_body_moved_to_ctor
   indent(o, 1) << "}\n";
 
+  lazy_o_ = nullptr;
+  lazy_o_file_.clear();
+  if(lib_split_ != lib_split_t::none){
+    //the methods go to the shared library of the group, with their own
+    //registration entry point
+    auto& lib_o = lib_group_code_[lib_group(t, current_cxx_file_)];
+    if(lazy_method_groups_.count(wrapper)){
+      lib_o << preamble.str() << "\n";
+      lib_o << "// Methods of " << (notype ? std::string("the global scope") : t.type_name)
+            << ", registered on first use\n";
+      lib_o << "JLCXX_MODULE define_julia_module_" << wrapper << "(jlcxx::Module& module_){\n";
+      if(notype){
+        indent(lib_o, 2) << "auto& t = module_;\n";
+      } else{
+        indent(lib_o, 2) << "jlcxx::TypeWrapper<" << add_type_param << "> t(module_, "
+                         << "jlcxx::julia_base_type<" << add_type_param << ">(), "
+                         << "jlcxx::julia_type<" << add_type_param << ">());\n";
+      }
+      lib_o << lazy.str();
+      lib_o << "}\n\n";
+    }
+  } else if(lazy_method_groups_.count(wrapper)){
+    //the methods are registered in the module passed as argument,
+    //defined by the define_julia_module_<wrapper> entry point
+    o << "\n";
+    indent(o, 1) << "void add_lazy_methods(jlcxx::Module& module_) const{\n";
+    if(notype){
+      indent(o, 2) << "auto& t = module_;\n";
+    } else{
+      indent(o, 2) << "jlcxx::TypeWrapper<" << add_type_param << "> t(module_, *type_);\n";
+    }
+    o << lazy.str();
+    indent(o, 1) << "}\n";
+  }
+
   if(!notype){
     o << "\nprivate:\n";
     indent(o, 1) <<  "std::unique_ptr<jlcxx::TypeWrapper<" << add_type_param << ">> type_;\n";
@@ -561,19 +661,23 @@ CodeTree::generate_cxx(){
 
   reset_wrapped_methods();
 
+  if(test_build_ || auto_veto_build_file_.size() > 0){
+    build_tester_ = std::make_unique<BuildTester>(join_paths(out_cxx_dir_, "test_build"),
+                                                  build_cmd_);
+  }
+
   //default filename for type wrapper code:
   std::string type_out_fname = std::string("jl") + module_name_ + ".cxx";
 
   std::string p(join_paths(out_cxx_dir_, type_out_fname));
-  FileTimeRestorer otimerstore(p);
-  std::ofstream o(p, out_open_mode_);
-  if(o.tellp() != 0){
+  if(is_in_the_way(p)){
     std::cerr << "File " << p
               << " in the way. Remove it or use the --force option.\n";
     //Cleanup:
     if(header_file_path_.size() > 0 ) fs::remove(header_file_path_.c_str());
     exit(1);
   }
+  BufferedFile o(p);
 
   o << "// this file was auto-generated by wrapit " << version << "\n";
 
@@ -585,6 +689,11 @@ CodeTree::generate_cxx(){
   o << "#include \"jl" << module_name_ << ".h\"\n\n"
     "#include <regex>\n\n";
 
+  if(isbits_types_.size() > 0){
+    o << "#include <cstddef>\n"
+      "#include <type_traits>\n\n";
+  }
+
   //FIXME
   //  for(const auto& t: types_missing_def_){
   //    o << "static_assert(is_type_complete_v<" << t
@@ -597,39 +706,22 @@ CodeTree::generate_cxx(){
 
   std::vector<std::string> wrappers;
 
-  //File stream to write type wrapper,
-  //current file by default
-  std::ofstream type_out;
-  std::ofstream* pout = &o;
+  //Types to wrap grouped by output file, in the generation order. The
+  //partitioning was decided by update_wrapper_filenames().
+  std::vector<std::pair<std::string, std::vector<unsigned>>> file_groups;
 
-  int nignoredlines = 1;
-  FileTimeRestorer timerestore;
   int i_towrap_type = -1;
-  //  for(const auto& c: types_){
   for(auto i: types_sorted_indices_){
     auto& c = types_[i];
     if(!c.to_wrap) continue;
     ++i_towrap_type;
 
-    c.setStrictNumberTypeFlags(type_map_);
-
-    if(towrap_type_filenames_.size() > 0
-       && towrap_type_filenames_[i_towrap_type] != type_out_fname){
-
+    if(towrap_type_filenames_.size() > 0){
       type_out_fname = towrap_type_filenames_.at(i_towrap_type);
-      std::string type_out_fpath =
-        join_paths(out_cxx_dir_, towrap_type_filenames_[i_towrap_type]);
+    }
 
-      if(pout != &o){
-        pout->close();
-        if(update_mode_){
-          timerestore.settimestamp();
-        }
-      }
-      if(update_mode_) timerestore = FileTimeRestorer(type_out_fpath, nignoredlines);
-      type_out = checked_open(type_out_fpath);
-      pout = &type_out;
-      generate_type_wrapper_header(*pout);
+    if(file_groups.empty() || file_groups.back().first != type_out_fname){
+      file_groups.emplace_back(type_out_fname, std::vector<unsigned>());
     }
 
     const auto& t = clang_getCursorType(c.cursor);
@@ -642,17 +734,42 @@ CodeTree::generate_cxx(){
       continue;
     }
 
-
     if(c.type_name.size() == 0 //holder of global functions and variables
        || t.kind == CXType_Record || c.template_parameter_combinations.size() > 0){
       wrappers.emplace_back(wrapper_classsname(c.type_name));
-      generate_cxx_for_type((*pout), c);
+      file_groups.back().second.push_back(i);
+      if(lib_split_ != lib_split_t::none){
+        const auto& group = lib_group(c, type_out_fname);
+        lib_group_of_wrapper_[wrappers.back()] = group;
+        lib_group_sources_[group].insert(lib_group_filename(type_out_fname, group));
+      }
     }
   }
 
-  if(pout != (&o)){
-    pout->close();
-    timerestore.settimestamp();
+  //Code of the types assigned to the main file (n_classes_per_file = 0)
+  //is written in o.
+  const std::string main_fname = std::string("jl") + module_name_ + ".cxx";
+  const bool main_file_used = std::any_of(file_groups.begin(), file_groups.end(),
+                                          [&](const auto& g){
+                                            return g.first == main_fname;
+                                          });
+
+  //The code blocks recorded for the test build are not
+  //collected from the child processes: parallel generation
+  //is disabled in this mode.
+  if(njobs_ > 1 && !main_file_used && file_groups.size() > 1 && !build_tester_){
+    generate_type_files_in_parallel(file_groups);
+  } else{
+    for(const auto& g: file_groups){
+      current_cxx_file_ = g.first;
+      if(g.first == main_fname){
+        for(auto i: g.second) generate_cxx_for_type(o, types_[i]);
+        write_ccall_thunks(o);
+        write_lib_group_files(g.first);
+      } else{
+        generate_type_file(g.first, g.second);
+      }
+    }
   }
 
   o << "\n";
@@ -669,6 +786,14 @@ CodeTree::generate_cxx(){
 
   generate_version_check_cxx(o);
 
+  if(isbits_types_.size() > 0) generate_isbits_cxx(o);
+
+  //wrappers used by the define_julia_module_<wrapper> entry points
+  const bool keep_wrappers = lazy_method_registration_ && lib_split_ == lib_split_t::none;
+  if(keep_wrappers){
+    o << "\nstatic std::vector<std::shared_ptr<Wrapper>> wrappers;\n";
+  }
+
   o << "\n\nJLCXX_MODULE define_julia_module(jlcxx::Module& jlModule){\n";
 
 
@@ -685,11 +810,27 @@ CodeTree::generate_cxx(){
                  << ">(\"" << type_pair.second << "\");\n";
   }
 
+  if(isbits_types_.size() > 0){
+    indent(o, 1) << "// mapping of the types to the isbits structs defined in the\n";
+    indent(o, 1) << "// Julia module, with layout checked at compilation time\n";
+  }
+
+  for(const auto& t: isbits_types_){
+    indent(o, 1) << "jlModule.map_type<" << t.type_name
+                 << ">(\"" << t.jl_name << "\");\n";
+  }
+
   for(const auto& e: enums_){
     generate_enum_cxx(o, e.cursor);
   }
 
-  indent(o, 1) << "std::vector<std::shared_ptr<Wrapper>> wrappers = {\n";
+  //In lazy_method_registration mode, the wrappers are kept for the
+  //define_julia_module_<wrapper> entry points.
+  if(keep_wrappers){
+    indent(o, 1) << "wrappers = {\n";
+  } else{
+    indent(o, 1) << "std::vector<std::shared_ptr<Wrapper>> wrappers = {\n";
+  }
   std::string sep;
   for(const auto& w: wrappers){
     indent(o << sep, 2) << "std::shared_ptr<Wrapper>(new" << w << "(jlModule))";
@@ -701,12 +842,18 @@ CodeTree::generate_cxx(){
   indent(o, 1) << "for(const auto& w: wrappers) w->add_methods();\n";
 
   o << "\n}\n";
+
+  for(unsigned iw = 0; iw < wrappers.size() && keep_wrappers; ++iw){
+    if(lazy_method_groups_.count(wrappers[iw]) == 0) continue;
+    o << "\nJLCXX_MODULE define_julia_module_" << wrappers[iw]
+      << "(jlcxx::Module& jlModule){\n";
+    indent(o, 1) << "wrappers.at(" << iw << ")->add_lazy_methods(jlModule);\n";
+    o << "}\n";
+  }
   o.close();
-  otimerstore.settimestamp();
 
   auto fname = join_paths(out_cxx_dir_, "dbg_msg.h");
-  timerestore = FileTimeRestorer(fname);
-  std::ofstream o2 = checked_open(fname);
+  BufferedFile o2 = checked_open(fname);
   o2 << "#ifdef VERBOSE_IMPORT\n"
     "#  define DEBUG_MSG(a) std::cerr << a << \"\\n\"\n"
     "#else\n"
@@ -716,26 +863,45 @@ CodeTree::generate_cxx(){
     "#define QUOTE(arg) #arg\n"
     "#define QUOTE2(arg) QUOTE(arg)\n";
   o2.close();
-  timerestore.settimestamp();
 
   fname = join_paths(out_cxx_dir_, "Wrapper.h");
-  timerestore = FileTimeRestorer(fname);
   o2 = checked_open(fname);
   o2 << "#ifndef WRAPPER_H\n"
     "#define WRAPPER_H\n"
-    "#include \"jlcxx/jlcxx.hpp\"\n\n"
+    "#include \"jlcxx/jlcxx.hpp\"\n";
+  //std::snprintf of the ccall thunks
+  if(!ccall_list_.empty()) o2 << "#include <cstdio>\n";
+  o2 << "\n"
     "struct Wrapper{\n";
   indent(o2, 1) << "Wrapper(jlcxx::Module& module): module_(module) {};\n";
   indent(o2, 1) << "virtual ~Wrapper() {};\n";
   indent(o2, 1) << "virtual void add_methods() const = 0;\n";
+  if(lazy_method_registration_){
+    indent(o2, 1) << "virtual void add_lazy_methods(jlcxx::Module&) const {};\n";
+  }
   o2 << "\nprotected:\n";
   indent(o2, 1) << "jlcxx::Module& module_;\n";
-  o2 << "};\n"
-    "#endif //WRAPPER_H not defined\n";
+  o2 << "};\n";
+  if(!gc_safe_list_.empty()){
+    //the function names are parenthesized to not be taken for the
+    //one-argument macros of the same names defined by some Julia versions
+    o2 << "\n"
+      "// Scope in which the calling Julia thread is in GC-safe state: the\n"
+      "// garbage collector can run in the other threads. Julia objects must\n"
+      "// not be accessed within.\n"
+      "struct WrapitGcSafeRegion{\n";
+    indent(o2, 1) << "WrapitGcSafeRegion(): state_((jl_gc_safe_enter)()) {}\n";
+    indent(o2, 1) << "~WrapitGcSafeRegion() { (jl_gc_safe_leave)(state_); }\n";
+    indent(o2, 1) << "WrapitGcSafeRegion(const WrapitGcSafeRegion&) = delete;\n";
+    indent(o2, 1) << "WrapitGcSafeRegion& operator=(const WrapitGcSafeRegion&) = delete;\n";
+    o2 << "private:\n";
+    indent(o2, 1) << "int8_t state_;\n";
+    o2 << "};\n";
+  }
+  o2 << "#endif //WRAPPER_H not defined\n";
   o2.close();
-  timerestore.settimestamp();
 
-  o2 = std::ofstream(join_paths(out_cxx_dir_, "generated_cxx"));
+  o2 = BufferedFile(join_paths(out_cxx_dir_, "generated_cxx"));
   o2 << "jl" << module_name_ << ".cxx";
   for(const auto& fname: towrap_type_filenames_set_){
     o2 << " " << fname;
@@ -784,7 +950,7 @@ CodeTree::generate_cxx(){
     content.insert(0, "set(WRAPIT_DEPENDS ");
     content.append(")\n");
 
-    o2 = std::ofstream(cmake_);
+    o2 = BufferedFile(cmake_, /*only_if_changed=*/false);
 
     o2 << "# File generated by wrapit version " << version << "\n";
     auto t = time(0);
@@ -800,6 +966,8 @@ CodeTree::generate_cxx(){
 
     o2 << "\n# List of files the produced file contents depend on:\n"
        << content;
+
+    if(lib_split_ != lib_split_t::none) generate_lib_groups_cmake(o2);
     o2.close();
   }
 
@@ -808,10 +976,61 @@ CodeTree::generate_cxx(){
   if(type_dependencies_.isCyclic()){
     std::cerr << "Warning: cyclic class dependency found. "
       "This can lead to a \"No factory for type X\" error when loading "
-      "the wrapper Julia module.\n";
+      "the wrapper Julia module. Types of the dependency cycles:\n";
+    for(const auto& cycle: type_dependencies_.cycles()){
+      std::cerr << "  " << dependency_cycle_str(cycle) << "\n";
+    }
   }
 }
 
+std::string CodeTree::dependency_cycle_str(const std::vector<unsigned>& cycle) const{
+  std::string r;
+  std::string sep;
+  for(auto i: cycle){
+    r += sep + types_[i].type_name;
+    sep = ", ";
+  }
+  return r;
+}
+
+std::ostream& CodeTree::generate_lib_groups_cmake(std::ostream& o) const{
+  o << "\n# Libraries of the methods registered on first use (lib_split mode).\n"
+    "# The WRAPIT_PRODUCTS files make the core library, which registers the\n"
+    "# types. Each group of WRAPIT_LIB_GROUPS makes a separate library, whose\n"
+    "# sources are listed in WRAPIT_LIB_<group>_SOURCES.\n"
+    "set(WRAPIT_LIB_GROUPS";
+  for(const auto& g: lib_group_sources_) o << "\n  " << g.first;
+  o << ")\n";
+
+  for(const auto& [group, sources]: lib_group_sources_){
+    o << "\nset(WRAPIT_LIB_" << group << "_SOURCES";
+    for(const auto& fname: sources) o << "\n  " << join_paths(out_cxx_dir_, fname);
+    o << ")\n";
+  }
+
+  o << "\n# Defines the targets of the group libraries, <core_target>_<group>, with the\n"
+    "# include directories, link libraries, and output directory of the core\n"
+    "# library target. The library file names must match the lib_basename\n"
+    "# parameter followed by _<group>.\n"
+    "function(wrapit_add_lib_groups core_target)\n"
+    "  foreach(group ${WRAPIT_LIB_GROUPS})\n"
+    "    set(target ${core_target}_${group})\n"
+    "    add_library(${target} SHARED ${WRAPIT_LIB_${group}_SOURCES})\n"
+    "    target_include_directories(${target} PRIVATE\n"
+    "      $<TARGET_PROPERTY:${core_target},INCLUDE_DIRECTORIES>)\n"
+    "    target_link_libraries(${target} PRIVATE\n"
+    "      $<TARGET_PROPERTY:${core_target},LINK_LIBRARIES>)\n"
+    "    get_target_property(outdir ${core_target} LIBRARY_OUTPUT_DIRECTORY)\n"
+    "    if(outdir)\n"
+    "      set_target_properties(${target} PROPERTIES LIBRARY_OUTPUT_DIRECTORY ${outdir})\n"
+    "    endif()\n"
+    "    add_dependencies(${target} ${core_target})\n"
+    "  endforeach()\n"
+    "endfunction()\n";
+
+  return o;
+}
+
 std::ostream& CodeTree::generate_type_wrapper_header(std::ostream& o) const{
   o << "// this file was auto-generated by wrapit " << version << "\n"
     "#include \"Wrapper.h\"\n\n"
@@ -823,13 +1042,358 @@ std::ostream& CodeTree::generate_type_wrapper_header(std::ostream& o) const{
   return o;
 }
 
-std::ofstream CodeTree::checked_open(const std::string& path) const{
-  std::ofstream o(path.c_str(), out_open_mode_);
-  if(o.tellp() > 0){
+void CodeTree::generate_type_file(const std::string& fname,
+                                  const std::vector<unsigned>& itypes){
+  std::string fpath = join_paths(out_cxx_dir_, fname);
+  int nignoredlines = 1;
+  BufferedFile o = checked_open(fpath, true, nignoredlines);
+  generate_type_wrapper_header(o);
+  current_cxx_file_ = fname;
+  for(auto i: itypes){
+    generate_cxx_for_type(o, types_[i]);
+  }
+  write_ccall_thunks(o);
+  o.close();
+  write_lib_group_files(fname);
+}
+
+void CodeTree::write_ccall_thunks(std::ostream& o){
+  const auto& code = ccall_thunks_.str();
+  if(code.empty()) return;
+  o << "\n// Functions called from Julia with ccall (ccall_functions parameter)\n"
+    << code;
+  ccall_thunks_.str("");
+}
+
+std::string CodeTree::lib_group(const TypeRcd& t, const std::string& fname) const{
+  if(lib_split_ == lib_split_t::files){
+    return fs::path(fname).stem().string();
+  }
+  //top-level namespace
+  auto pos = t.type_name.find("::");
+  if(t.type_name.size() == 0 || pos == std::string::npos) return "global";
+  return t.type_name.substr(0, pos);
+}
+
+std::string CodeTree::lib_group_filename(const std::string& fname,
+                                         const std::string& group) const{
+  auto stem = fs::path(fname).stem().string();
+  if(stem == group) return stem + "_methods.cxx";
+  else return stem + "_" + group + "_methods.cxx";
+}
+
+void CodeTree::write_lib_group_files(const std::string& fname){
+  for(auto& [group, code]: lib_group_code_){
+    std::string fpath = join_paths(out_cxx_dir_, lib_group_filename(fname, group));
+    int nignoredlines = 1;
+    BufferedFile o = checked_open(fpath, true, nignoredlines);
+    generate_type_wrapper_header(o);
+    o << code.str();
+    o.close();
+  }
+  lib_group_code_.clear();
+}
+
+struct CodeTree::generation_snapshot_t{
+  size_t n_wrapped_methods;
+  size_t n_overlap_skipped_methods;
+  size_t n_get_index_generated;
+  decltype(CodeTree::nwraps_) nwraps;
+  decltype(CodeTree::method_cache_stats_) method_cache_stats;
+  decltype(CodeTree::lazy_method_groups_) lazy_method_groups;
+};
+
+void CodeTree::save_generation_state(std::ostream& o,
+                                     const generation_snapshot_t& snapshot) const{
+  write_strs(o, wrapped_methods_, snapshot.n_wrapped_methods);
+  write_strs(o, wrapped_methods_after_map_, snapshot.n_wrapped_methods);
+
+  std::vector<std::string> overlaps;
+  for(unsigned j = snapshot.n_overlap_skipped_methods;
+      j < overlap_skipped_methods_.size(); ++j){
+    overlaps.push_back(overlap_skipped_methods_[j].first);
+    overlaps.push_back(overlap_skipped_methods_[j].second);
+  }
+  write_strs(o, overlaps);
+
+  write_strs(o, get_index_generated_, snapshot.n_get_index_generated);
+  write_strs(o, to_export_);
+
+  for(const auto* v: { &vetoed_types_, &vetoed_enums_, &vetoed_methods_,
+        &vetoed_globfuncs_, &vetoed_specializations_,
+        &vetoed_field_accessors_, &vetoed_globvar_accessors_,
+        &vetoed_field_setters_, &vetoed_globvar_setters_}){
+    write_strs(o, *v);
+  }
+
+  o << import_getindex_ << " " << import_setindex_ << "\n";
+
+  const auto& n0 = snapshot.nwraps;
+  o << nwraps_.enums - n0.enums << " "
+    << nwraps_.types - n0.types << " "
+    << nwraps_.type_templates - n0.type_templates << " "
+    << nwraps_.methods - n0.methods << " "
+    << nwraps_.field_getters - n0.field_getters << " "
+    << nwraps_.field_setters - n0.field_setters << " "
+    << nwraps_.global_var_getters - n0.global_var_getters << " "
+    << nwraps_.global_var_setters - n0.global_var_setters << " "
+    << nwraps_.global_funcs - n0.global_funcs << " "
+    << nwraps_.lambdas - n0.lambdas << "\n";
+
+  o << method_cache_stats_.hits - snapshot.method_cache_stats.hits << " "
+    << method_cache_stats_.misses - snapshot.method_cache_stats.misses << "\n";
+
+  //groups of the lazy_method_registration mode, as (group, name) pairs
+  std::vector<std::string> lazy_groups;
+  for(const auto& g: lazy_method_groups_){
+    if(snapshot.lazy_method_groups.count(g.first)) continue;
+    lazy_groups.push_back(g.first);
+    lazy_groups.push_back(std::to_string(g.second.size()));
+    lazy_groups.insert(lazy_groups.end(), g.second.begin(), g.second.end());
+  }
+  write_strs(o, lazy_groups);
+
+  //ptr_adapter strategy, as (function, class) pairs
+  std::vector<std::string> adapters;
+  for(const auto& [f, classes]: ptr_adapters_){
+    for(const auto& c: classes){
+      adapters.push_back(f);
+      adapters.push_back(c);
+    }
+  }
+  write_strs(o, adapters);
+
+  write_strs(o, std::vector<std::string>(broadcast_jl_.begin(), broadcast_jl_.end()));
+
+  std::vector<std::string> ccall_methods;
+  for(const auto& [head, methods]: ccall_jl_){
+    for(const auto& [exact_head, call]: methods){
+      ccall_methods.push_back(head);
+      ccall_methods.push_back(exact_head);
+      ccall_methods.push_back(call);
+    }
+  }
+  write_strs(o, ccall_methods);
+
+  Profiler::instance().save(o);
+}
+
+void CodeTree::merge_generation_state(std::istream& i){
+  const auto& methods = read_strs(i);
+  const auto& methods_after_map = read_strs(i);
+  for(unsigned j = 0; j < methods.size() && j < methods_after_map.size(); ++j){
+    wrapped_methods_.push_back(methods[j]);
+    wrapped_methods_after_map_.push_back(methods_after_map[j]);
+    wrapped_methods_after_map_set_.insert(methods_after_map[j]);
+  }
+
+  const auto& overlaps = read_strs(i);
+  for(unsigned j = 0; j + 1 < overlaps.size(); j += 2){
+    overlap_skipped_methods_.emplace_back(overlaps[j], overlaps[j+1]);
+  }
+
+  for(const auto& s: read_strs(i)) get_index_generated_.push_back(s);
+  for(const auto& s: read_strs(i)) to_export_.insert(s);
+
+  for(auto* v: { &vetoed_types_, &vetoed_enums_, &vetoed_methods_,
+        &vetoed_globfuncs_, &vetoed_specializations_,
+        &vetoed_field_accessors_, &vetoed_globvar_accessors_,
+        &vetoed_field_setters_, &vetoed_globvar_setters_}){
+    for(const auto& s: read_strs(i)) v->insert(s);
+  }
+
+  bool getindex = false, setindex = false;
+  i >> getindex >> setindex;
+  import_getindex_ |= getindex;
+  import_setindex_ |= setindex;
+
+  unsigned n[10] = {0};
+  for(auto& x: n) i >> x;
+  nwraps_.enums              += n[0];
+  nwraps_.types              += n[1];
+  nwraps_.type_templates     += n[2];
+  nwraps_.methods            += n[3];
+  nwraps_.field_getters      += n[4];
+  nwraps_.field_setters      += n[5];
+  nwraps_.global_var_getters += n[6];
+  nwraps_.global_var_setters += n[7];
+  nwraps_.global_funcs       += n[8];
+  nwraps_.lambdas            += n[9];
+
+  unsigned hits = 0, misses = 0;
+  i >> hits >> misses;
+  method_cache_stats_.hits += hits;
+  method_cache_stats_.misses += misses;
+
+  const auto& lazy_groups = read_strs(i);
+  for(unsigned j = 0; j + 1 < lazy_groups.size();){
+    auto& names = lazy_method_groups_[lazy_groups[j]];
+    unsigned n = std::stoul(lazy_groups[j + 1]);
+    j += 2;
+    for(unsigned k = 0; k < n && j < lazy_groups.size(); ++k, ++j){
+      names.insert(lazy_groups[j]);
+    }
+  }
+
+  const auto& adapters = read_strs(i);
+  for(unsigned j = 0; j + 1 < adapters.size(); j += 2){
+    ptr_adapters_[adapters[j]].insert(adapters[j+1]);
+  }
+
+  for(const auto& s: read_strs(i)) broadcast_jl_.insert(s);
+
+  const auto& ccall_methods = read_strs(i);
+  for(unsigned j = 0; j + 2 < ccall_methods.size(); j += 3){
+    ccall_jl_[ccall_methods[j]][ccall_methods[j+1]] = ccall_methods[j+2];
+  }
+
+  if(!Profiler::instance().merge(i)){
+    std::cerr << "Warning: failed to read back the profiling records of a "
+      "code generation process.\n";
+  }
+}
+
+void
+CodeTree::generate_type_files_in_parallel(const std::vector<std::pair<std::string,
+                                          std::vector<unsigned>>>& file_groups){
+
+  //libclang gives no guarantee of thread safety when walking the AST
+  //(declarations are deserialized lazily and the type spellings rely on shared
+  //caches), therefore the work is distributed to processes: each child inherits
+  //a copy of the parsed tree, writes its share of the files and sends back
+  //the bookkeeping that the serial code would have accumulated. The shares are
+  //contiguous in the generation order and merged in that order, which makes
+  //the result identical to a serial run.
+  size_t ntypes = 0;
+  for(const auto& g: file_groups) ntypes += g.second.size();
+
+  unsigned njobs = std::min<size_t>(njobs_, file_groups.size());
+
+  //first group index of each job. Groups are assigned such that every job
+  //gets about the same number of types.
+  std::vector<size_t> job_starts;
+  size_t cumul = 0;
+  for(size_t igroup = 0; igroup < file_groups.size(); ++igroup){
+    size_t remaining_groups = file_groups.size() - igroup;
+    size_t remaining_jobs = njobs - job_starts.size();
+    if(remaining_jobs > 0
+       && (job_starts.empty()
+           || cumul * njobs >= ntypes * job_starts.size()
+           || remaining_groups <= remaining_jobs)){
+      job_starts.push_back(igroup);
+    }
+    cumul += file_groups[igroup].second.size();
+  }
+  job_starts.push_back(file_groups.size());
+  njobs = job_starts.size() - 1;
+
+  if(verbose > 0){
+    std::cerr << "Info: generating the " << file_groups.size()
+              << " wrapper files with " << njobs << " processes.\n";
+  }
+
+  generation_snapshot_t snapshot = { wrapped_methods_.size(),
+                                     overlap_skipped_methods_.size(),
+                                     get_index_generated_.size(),
+                                     nwraps_,
+                                     method_cache_stats_,
+                                     lazy_method_groups_ };
+
+  //The states are passed back through files of a private directory
+  //(mode 0700, unique name) of the output directory. The directory is
+  //removed before any exit of the function.
+  std::string state_dir = join_paths(out_cxx_dir_, ".wrapit-state-XXXXXX");
+  if(mkdtemp(state_dir.data()) == nullptr){
+    std::cerr << "Warning: failed to create a temporary directory in "
+              << out_cxx_dir_ << " (" << strerror(errno) << "). Wrapper files "
+      "will be generated sequentially.\n";
+    for(const auto& g: file_groups) generate_type_file(g.first, g.second);
+    return;
+  }
+
+  std::vector<pid_t> pids;
+  std::vector<std::string> state_files(njobs);
+
+  //Prevents duplication of buffered messages by the forks:
+  std::cout.flush();
+  std::cerr.flush();
+  fflush(stdout);
+  fflush(stderr);
+
+  for(unsigned ijob = 0; ijob < njobs; ++ijob){
+    state_files[ijob] = join_paths(state_dir, "job" + std::to_string(ijob) + ".state");
+    pid_t pid = fork();
+    if(pid < 0){
+      std::cerr << "Warning: failed to fork a code generation process ("
+                << strerror(errno) << "). Generation of the remaining files "
+                "will be done sequentially.\n";
+      break;
+    }
+
+    if(pid == 0){
+      Profiler::instance().start_worker(ijob);
+      for(size_t igroup = job_starts[ijob]; igroup < job_starts[ijob + 1]; ++igroup){
+        generate_type_file(file_groups[igroup].first, file_groups[igroup].second);
+      }
+      std::ofstream state(state_files[ijob]);
+      save_generation_state(state, snapshot);
+      state.close();
+      std::cout.flush();
+      std::cerr.flush();
+      //skip the exit handlers and destructors of the state shared
+      //with the parent process:
+      _exit(state ? 0 : 1);
+    }
+
+    pids.push_back(pid);
+  }
+
+  //The forked jobs are the first ones: their states are merged before
+  //the serial generation of the jobs that could not be forked, which
+  //preserves the generation order.
+  bool failed = false;
+  for(unsigned ijob = 0; ijob < pids.size(); ++ijob){
+    int status = 0;
+    waitpid(pids[ijob], &status, 0);
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+      std::cerr << "Error: code generation process #" << ijob << " failed.\n";
+      failed = true;
+    } else {
+      std::ifstream state(state_files[ijob]);
+      merge_generation_state(state);
+    }
+  }
+
+  std::error_code ec;
+  fs::remove_all(state_dir, ec);
+
+  if(failed){
+    if(header_file_path_.size() > 0 ) fs::remove(header_file_path_.c_str());
+    exit(1);
+  }
+
+  //fork failure, fallback to serial mode
+  for(unsigned ijob = pids.size(); ijob < njobs; ++ijob){
+    for(size_t igroup = job_starts[ijob]; igroup < job_starts[ijob + 1]; ++igroup){
+      generate_type_file(file_groups[igroup].first, file_groups[igroup].second);
+    }
+  }
+}
+
+bool CodeTree::is_in_the_way(const std::string& path) const{
+  if(!(out_open_mode_ & std::ios_base::app)) return false;
+  std::error_code ec;
+  auto size = fs::file_size(path, ec);
+  return !ec && size > 0;
+}
+
+BufferedFile CodeTree::checked_open(const std::string& path, bool only_if_changed,
+                                    int nskiplines) const{
+  if(is_in_the_way(path)){
     std::cerr << "File " << path << " in the way. Remove it or use the --force option.\n";
     exit(1);
   }
-  return o;
+  return BufferedFile(path, only_if_changed, nskiplines);
 }
 
 
@@ -853,7 +1417,15 @@ std::ostream& CodeTree::show_stats(std::ostream& o) const{
     << nwraps_.global_var_setters << " setters\n"
     << std::setw(20) << std::left << "  global functions: "
     << nwraps_.global_funcs << "\n"
+    << std::setw(20) << std::left << "  lambda functions: "
+    << nwraps_.lambdas << "\n"
     << "\n";
+  if(verbose > 0){
+    o << "Method list cache: " << method_cache_stats_.hits << " hits, "
+      << method_cache_stats_.misses << " misses\n"
+      << "Signature cache: " << signature_cache_.hits() << " hits, "
+      << signature_cache_.misses() << " misses\n\n";
+  }
   return o;
 }
 
@@ -867,12 +1439,27 @@ CodeTree::generate_accessor_cxx(std::ostream& o, const TypeRcd* type_rcd,
                          cxxwrap_version_,  "", "", nindents);
 
   int ngens = 0;
-  helper.gen_accessors(o, getter_only, &ngens);
+  if(build_tester_){
+    std::stringstream code;
+    helper.gen_accessors(code, getter_only, &ngens);
+    o << code.str();
+    add_test_build_block(fully_qualified_name(cursor),
+                         type_rcd ? type_rcd->type_name : std::string(),
+                         code.str(), o);
+  } else{
+    helper.gen_accessors(o, getter_only, &ngens);
+  }
   if((type_rcd && export_mode_ >= export_mode_t::member_functions && type_rcd)
      || export_mode_ >= export_mode_t::all_functions){
     for(const auto& n: helper.generated_jl_functions()) to_export_.insert(n);
   }
 
+  if(lazy_o_ && ngens > 0){
+    for(const auto& n: helper.generated_jl_functions()){
+      lazy_method_groups_[lazy_group_].insert(n);
+    }
+  }
+
   const int ngetters = ngens > 0 ? 1 : 0;
   const int nsetters = ngens > 1 ? 1 : 0;
 
@@ -965,25 +1552,208 @@ void CodeTree::set_type_rcd_ctor_info(TypeRcd& rcd){
 }
 
 void
-CodeTree::test_build(std::ostream& o){
-  ++ibuild_;
-  int i = ibuild_ - build_nskips_;
-  if(build_nskips_ < 0 || ibuild_ <= build_nskips_ || i % build_every_ != 0){
-    std::cerr << ibuild_ << " built skipped.\n";
-  } else if (build_nmax_ <= 0 || i <= build_nmax_){
-    auto p = o.tellp();
-    o << "}\n";
-    o.flush();
+CodeTree::add_test_build_block(const std::string& signature, const std::string& type,
+                               const std::string& code, const std::ostream& o){
+  if(!build_tester_) return;
+  const auto& file = (&o == lazy_o_ && !lazy_o_file_.empty()) ? lazy_o_file_ : current_cxx_file_;
+  build_tester_->add_block(BuildTester::Block{signature, type, code, file});
+}
+
+bool
+CodeTree::prepare_build_tester(){
+  //prefix header, with the same includes as the type wrapper files
+  const auto& dir = fs::absolute(out_cxx_dir_).string();
+  std::stringstream prefix;
+  prefix << "#include \"" << join_paths(dir, "Wrapper.h") << "\"\n"
+         << "#include \"" << join_paths(dir, std::string("jl") + module_name_ + ".h") << "\"\n"
+         << "#include \"" << join_paths(dir, "dbg_msg.h") << "\"\n"
+         << "#include \"jlcxx/functions.hpp\"\n"
+         << "#include \"jlcxx/stl.hpp\"\n";
+  build_tester_->set_prefix(prefix.str());
+  build_tester_->set_njobs(njobs_);
+
+  return build_tester_->prepare();
+}
+
+bool
+CodeTree::run_auto_veto_build(){
+  if(auto_veto_build_file_.empty() || !build_tester_) return true;
+
+  if(!prepare_build_tester()) return false;
+
+  std::vector<std::string> fnames;
+  if(towrap_type_filenames_set_.empty()){
+    fnames.push_back(std::string("jl") + module_name_ + ".cxx");
+  } else{
+    fnames.assign(towrap_type_filenames_set_.begin(), towrap_type_filenames_set_.end());
+  }
+  //method code of the shared libraries of the lib_split mode
+  for(const auto& g: lib_group_sources_){
+    fnames.insert(fnames.end(), g.second.begin(), g.second.end());
+  }
+
+  std::vector<std::string> paths;
+  for(const auto& f: fnames) paths.push_back(join_paths(out_cxx_dir_, f));
+
+  std::cerr << "Info: compiling the " << paths.size() << " generated wrapper files "
+            << "with " << njobs_ << " processes to build the veto list.\n";
 
-    std::cerr << "build # " << ibuild_ << "\n";
-    int rc = system(build_cmd_.c_str());
-    o.seekp(p);
+  const auto& results = build_tester_->compile_files(paths);
 
-    if(rc!=0){
-      std::cerr << "Build failed. Abort the code generation.\n";
-      exit(rc);
+  //Blocks of the files failing to compile, split to use all
+  //the processes from the start of the bisection
+  const auto& blocks = build_tester_->blocks();
+  std::vector<std::vector<unsigned>> batches;
+  std::set<std::string> failed_files;
+  for(unsigned i = 0; i < fnames.size(); ++i){
+    if(results[i]) continue;
+    failed_files.insert(fnames[i]);
+    std::vector<unsigned> iblocks;
+    for(unsigned j = 0; j < blocks.size(); ++j){
+      if(blocks[j].file == fnames[i]) iblocks.push_back(j);
+    }
+    const unsigned nbatches = std::max(1u, std::min<unsigned>(njobs_, iblocks.size()));
+    for(unsigned k = 0; k < nbatches; ++k){
+      batches.emplace_back(iblocks.begin() + k * iblocks.size() / nbatches,
+                           iblocks.begin() + (k + 1) * iblocks.size() / nbatches);
+    }
+  }
+
+  std::cerr << "Info: " << failed_files.size() << " file"
+            << (failed_files.size() > 1 ? "s" : "") << " failed to compile.\n";
+
+  std::vector<unsigned> failures;
+  if(!build_tester_->failing_blocks(batches, failures)) return false;
+
+  std::set<std::string> explained_files;
+  std::vector<std::string> signatures;
+  for(auto i: failures){
+    explained_files.insert(blocks[i].file);
+    if(std::find(signatures.begin(), signatures.end(), blocks[i].signature)
+       == signatures.end()){
+      signatures.push_back(blocks[i].signature);
     }
   }
+
+  for(const auto& f: failed_files){
+    if(explained_files.count(f) == 0){
+      std::cerr << "Warning: the compilation of " << f << " fails on code that "
+        "could not be attributed to a function or variable wrapper. See the "
+        "compilation log in " << join_paths(out_cxx_dir_, "test_build") << ".\n";
+    }
+  }
+
+  std::ofstream o(auto_veto_build_file_);
+  auto t = time(0);
+  o << "# Veto list generated by wrapit " << version << " --auto-veto-build\n"
+    << "# Generation time: " << ctime(&t)
+    << "# Wrappers failing to compile:\n";
+  for(const auto& s: signatures) o << s << "\n";
+  o.close();
+
+  if(o.fail()){
+    std::cerr << "Error: failed to write the veto file " << auto_veto_build_file_ << ".\n";
+    return false;
+  }
+
+  std::cerr << "Info: " << signatures.size() << " signature"
+            << (signatures.size() > 1 ? "s" : "") << " written in "
+            << auto_veto_build_file_ << " after "
+            << build_tester_->ncompilations() << " compilations.\n";
+
+  return true;
+}
+
+bool
+CodeTree::run_test_build(){
+  if(!build_tester_ || !test_build_) return true;
+
+  const auto& nblocks = build_tester_->blocks().size();
+
+  std::vector<std::vector<unsigned>> batches;
+  if(build_nskips_ >= 0){
+    const unsigned batch_size = build_every_ > 0 ? build_every_ : 1;
+    for(unsigned i = build_nskips_; i < nblocks; i += batch_size){
+      if(build_nmax_ > 0 && batches.size() >= (unsigned) build_nmax_) break;
+      batches.emplace_back();
+      for(unsigned j = i; j < std::min<size_t>(i + batch_size, nblocks); ++j){
+        batches.back().push_back(j);
+      }
+    }
+  }
+
+  if(batches.empty()){
+    std::cerr << "Info: no code to test build.\n";
+    return true;
+  }
+
+  if(!prepare_build_tester()) return false;
+
+  std::cerr << "Info: test build of " << nblocks << " wrappers in "
+            << batches.size() << " batches with " << njobs_ << " processes.\n";
+
+  std::vector<unsigned> failures;
+  if(!build_tester_->failing_blocks(batches, failures)) return false;
+
+  std::cerr << "Info: " << build_tester_->ncompilations()
+            << " test compilations performed.\n";
+
+  if(failures.empty()){
+    std::cerr << "Info: test build succeeded.\n";
+    return true;
+  }
+
+  std::cerr << "Test build failed for the following wrappers "
+    "(signature to use in the veto file, generated file, compilation log):\n";
+  for(auto i: failures){
+    const auto& b = build_tester_->blocks()[i];
+    std::cerr << b.signature << "\t" << b.file << "\t"
+              << build_tester_->log_path(i) << "\n";
+  }
+
+  return false;
+}
+
+bool CodeTree::configure_method_wrapper(FunctionWrapper& wrapper,
+                                        const std::string& signature,
+                                        bool quiet) const{
+  //Call with the Julia thread in GC-safe state
+  if(!gc_safe_list_.empty() && gc_safe_list_.vetoed(signature)){
+    wrapper.set_gc_safe(true);
+  }
+
+  //Call from Julia with ccall through an extern "C" thunk
+  bool ccall = false;
+  if(!ccall_list_.empty() && wrapper.is_global()
+     && ccall_list_.vetoed(signature)){
+    const auto& err = wrapper.ccall_error();
+    if(err.empty()){
+      ccall = true;
+    } else if(verbose > 0 && !quiet){
+      std::cerr << "Warning: " << signature
+                << " is wrapped with CxxWrap instead of called with ccall: "
+                << err << ".\n";
+    }
+  }
+
+  wrapper.set_ptr_receiver_lambdas(method_wrapper_strategy_
+                                   == method_wrapper_strategy_t::lambdas);
+
+  wrapper.set_vector_overloads(vector_overloads_);
+
+  if(!broadcast_list_.empty() && broadcast_list_.vetoed(signature)){
+    const auto& err = wrapper.batch_error();
+    if(err.empty()){
+      wrapper.set_batch(true);
+    } else if(verbose > 0 && !quiet){
+      std::cerr << "Warning: no batched variant generated for "
+                << signature << ": " << err << ".\n";
+    }
+  }
+
+  wrapper.set_quiet(quiet);
+
+  return ccall;
 }
 
 std::ostream&
@@ -1000,17 +1770,19 @@ CodeTree::method_cxx_decl(std::ostream& o, const TypeRcd& typeRcd,
                           cxxwrap_version_, varname,
                           classname, nindents, templated);
 
+  //signatures from the cache, see signature()
+  const auto& sig = signature(method.cursor, &typeRcd);
+
   //FIXME: check that code below is needed. Should now be vetoed upstream
-  if(std::find(veto_list_.begin(), veto_list_.end(),
-               wrapper.signature()) != veto_list_.end()){
+  if(veto_list_.has_line(sig)){
     if(verbose > 0){
-      std::cerr << "Info: " << "func " << wrapper.signature() << " vetoed\n";
+      std::cerr << "Info: " << "func " << sig << " vetoed\n";
     }
     return o;
   }
 
-  auto cxxsignature = wrapper.signature(true);
-  auto exposed_cxxsignature = wrapper.signature(true, true);
+  auto cxxsignature = signature(method.cursor, &typeRcd, true, true);
+  auto exposed_cxxsignature = signature(method.cursor, &typeRcd, true, true, true);
   std::string already_existing_signature;
   bool new_decl = add_wrapped_method(cxxsignature,
                                      exposed_cxxsignature,
@@ -1031,16 +1803,53 @@ CodeTree::method_cxx_decl(std::ostream& o, const TypeRcd& typeRcd,
   }
 
   bool new_override_base = wrapper.override_base();
-  if(override_base_ && !new_override_base){
+
+  const bool ccall = configure_method_wrapper(wrapper, sig, /*quiet=*/false);
+
+  //Base extensions and constructors are not deferred: their first use
+  //cannot be intercepted from the Julia side.
+  const bool lazy = lazy_o_ && !templated && !wrapper.is_ctor() && !new_override_base
+    && !ccall;
+
+  if(lazy){
+    lazy_method_groups_[lazy_group_];
+  } else if(override_base_ && !new_override_base){
     indent(o << "\n", nindents) << "module_.unset_override_module();\n";
     override_base_ = new_override_base;
   } else if(!override_base_ && new_override_base){
     indent(o, nindents) << "module_.set_override_module(jl_base_module);\n";
     override_base_ = new_override_base;
   }
-  o << "\n";
 
-  wrapper.generate(o,  get_index_generated_);
+  std::ostream& out = lazy ? *lazy_o_ : o;
+  out << "\n";
+
+  if(ccall){
+    for(const auto& m: wrapper.gen_ccall(ccall_thunks_, "jl" + module_name_ + "_",
+                                         "__wrapit_lib")){
+      ccall_jl_[m.head][m.exact_head] = m.call;
+    }
+  } else if(build_tester_ && !templated){
+    std::stringstream code;
+    wrapper.generate(code,  get_index_generated_);
+    out << code.str();
+    add_test_build_block(sig, typeRcd.type_name, code.str(), out);
+  } else{
+    wrapper.generate(out,  get_index_generated_);
+  }
+
+  if(lazy){
+    for(const auto& n: wrapper.generated_jl_functions()){
+      lazy_method_groups_[lazy_group_].insert(n);
+    }
+  }
+
+  nwraps_.lambdas += wrapper.nlambdas();
+  const auto& broadcast_jl = wrapper.batch_broadcast_jl();
+  if(broadcast_jl.size() > 0) broadcast_jl_.insert(broadcast_jl);
+  if(wrapper.uses_ptr_receiver_adapter()){
+    ptr_adapters_[wrapper.name_jl()].insert(jl_type_name(typeRcd.type_name));
+  }
 
   import_getindex_ |= wrapper.defines_getindex();
   import_setindex_ |= wrapper.defines_setindex();
@@ -1185,13 +1994,36 @@ std::ostream& CodeTree::generate_jl(std::ostream& o,
 
   o <<  "\n"
     "using CxxWrap\n"
-    "import Libdl\n"
-    "@wrapmodule(()->\"" << shared_lib_basename<< ".\" * Libdl.dlext)\n"
+    "import Libdl\n";
+
+  //the structs must be defined before @wrapmodule maps the C++ types to them
+  if(isbits_types_.size() > 0){
+    generate_isbits_jl(o);
+    o << "\n";
+  }
+
+  o << "@wrapmodule(()->\"" << shared_lib_basename<< ".\" * Libdl.dlext)\n"
     "\n"
     "function __init__()\n"
     "    @initcxx\n"
     "end\n";
 
+  if(lazy_method_groups_.size() > 0){
+    generate_lazy_registration_jl(o, shared_lib_basename);
+  }
+
+  if(ccall_jl_.size() > 0){
+    generate_ccall_jl(o, shared_lib_basename);
+  }
+
+  if(ptr_adapters_.size() > 0){
+    generate_ptr_adapters_jl(o);
+  }
+
+  if(broadcast_jl_.size() > 0){
+    generate_broadcast_jl(o);
+  }
+
   //FIXME add code documentation generation
   //  for(const auto& t: types){
   //    if(t->wrapper()!=Entity::kNoWrapper && t->docstring().size() > 0){
@@ -1214,6 +2046,161 @@ std::ostream& CodeTree::generate_jl(std::ostream& o,
   return o;
 }
 
+std::ostream&
+CodeTree::generate_ptr_adapters_jl(std::ostream& o) const{
+  o << "\n"
+    "# Calls of class methods on pointers (method_wrapper_strategy = \"ptr_adapter\")\n";
+  for(const auto& [f, classes]: ptr_adapters_){
+    const auto& fjl = jl_identifier(f);
+    o << fjl << "(a::Union{";
+    const char* sep = "";
+    for(const auto& c: classes){
+      const auto& cjl = jl_identifier(c);
+      o << sep << "CxxPtr{<:" << cjl << "}, ConstCxxPtr{<:" << cjl << "}";
+      sep = ", ";
+    }
+    o << "}, args...) = " << fjl << "(a[], args...)\n";
+  }
+  return o;
+}
+
+std::ostream&
+CodeTree::generate_broadcast_jl(std::ostream& o) const{
+  o << "\n"
+    "# Broadcast calls over vectors performed by a single call to the batched\n"
+    "# variant of the function (broadcast_methods parameter)\n";
+  for(const auto& s: broadcast_jl_) o << s << "\n";
+  return o;
+}
+
+std::ostream&
+CodeTree::generate_ccall_jl(std::ostream& o,
+                            const std::string& shared_lib_basename) const{
+  o << "\n"
+    "# Functions called with ccall through extern \"C\" thunks of the library,\n"
+    "# without the CxxWrap dispatch (ccall_functions parameter)\n"
+    "const __wrapit_lib = \"" << shared_lib_basename << ".\" * Libdl.dlext\n";
+  for(const auto& [head, methods]: ccall_jl_){
+    if(methods.size() == 1){
+      o << head << " = " << methods.begin()->second << "\n";
+    } else{
+      //overloads that would define the same method, e.g. f(int) and
+      //f(long): the arguments must have the exact types
+      for(const auto& [exact_head, call]: methods){
+        o << exact_head << " = " << call << "\n";
+      }
+    }
+  }
+  return o;
+}
+
+std::ostream&
+CodeTree::generate_isbits_cxx(std::ostream& o) const{
+  o << "\n"
+    "// Layout of the types mapped to Julia isbits structs (isbits_types\n"
+    "// parameter). The Julia structs were generated for this layout.\n";
+  for(const auto& t: isbits_types_){
+    const auto& msg = "\"Layout of " + t.type_name + " differs from its Julia mirror\"";
+    o << "static_assert(std::is_standard_layout_v<" << t.type_name
+      << "> && std::is_trivially_copyable_v<" << t.type_name << ">, " << msg << ");\n"
+      << "static_assert(sizeof(" << t.type_name << ") == " << t.size
+      << " && alignof(" << t.type_name << ") == " << t.align << ", " << msg << ");\n";
+    for(const auto& f: t.fields){
+      o << "static_assert(offsetof(" << t.type_name << ", " << f.name << ") == "
+        << f.offset << ", " << msg << ");\n";
+    }
+  }
+  return o;
+}
+
+std::ostream&
+CodeTree::generate_isbits_jl(std::ostream& o) const{
+  o << "\n"
+    "# Mirrors of the C++ types listed in isbits_types, exchanged by value\n";
+  for(const auto& t: isbits_types_){
+    const auto& tjl = jl_identifier(t.jl_name);
+    o << "struct " << tjl << "\n";
+    for(const auto& f: t.fields){
+      o << "    " << jl_identifier(f.name) << "::" << f.jl_type << "\n";
+    }
+    o << "end\n";
+    o << "@assert isbitstype(" << tjl << ") && sizeof(" << tjl << ") == " << t.size
+      << " && Base.datatype_alignment(" << tjl << ") == " << t.align;
+    for(unsigned i = 0; i < t.fields.size(); ++i){
+      o << " &&\n        fieldoffset(" << tjl << ", " << (i + 1) << ") == "
+        << t.fields[i].offset;
+    }
+    o << " \"Layout of " << tjl << " differs from the one of the C++ type "
+      << t.type_name << "\"\n";
+  }
+  return o;
+}
+
+std::ostream&
+CodeTree::generate_lazy_registration_jl(std::ostream& o,
+                                        const std::string& shared_lib_basename) const{
+  o << "\n"
+    "# Methods registered on first use (lazy_method_registration mode).\n"
+    "# The methods of a class wrapper are defined by loading a submodule bound to\n"
+    "# the define_julia_module_<wrapper> entry point of the library. The first\n"
+    "# call to any of their functions triggers the loading.\n"
+    "const __wrapit_loaded_groups = Set{Symbol}()\n"
+    "\n"
+    "function __wrapit_load_group(group::Symbol, lib::String, names::String...)\n"
+    "    group in __wrapit_loaded_groups && return false\n"
+    "    push!(__wrapit_loaded_groups, group)\n"
+    "    libpath = lib * \".\" * Libdl.dlext\n"
+    "    entry = QuoteNode(Symbol(\"define_julia_module_\", group))\n"
+    "    # import ..name, for each function name, for the wrappers to extend\n"
+    "    # the functions of this module\n"
+    "    imports = Expr(:import, (Expr(:., :., :., Symbol(n)) for n in names)...)\n"
+    "    body = quote\n"
+    "        $imports\n"
+    "        using CxxWrap\n"
+    "        @wrapmodule(()->$libpath, $entry)\n"
+    "        function __init__()\n"
+    "            @initcxx\n"
+    "        end\n"
+    "    end\n"
+    "    Core.eval(@__MODULE__, Expr(:module, true, Symbol(\"__\", group), body))\n"
+    "    return true\n"
+    "end\n";
+
+  //Julia function name -> groups defining methods for it
+  std::map<std::string, std::vector<std::string>> groups_of_name;
+
+  o << "\n";
+  for(const auto& g: lazy_method_groups_){
+    //the library path is evaluated here, where @__DIR__ refers to the module file
+    std::string lib = shared_lib_basename;
+    auto it = lib_group_of_wrapper_.find(g.first);
+    if(it != lib_group_of_wrapper_.end()) lib += "_" + it->second;
+    o << "__wrapit_load_" << g.first << "() = __wrapit_load_group(:" << g.first
+      << ", \"" << lib << "\"";
+    for(const auto& n: g.second){
+      o << ", \"" << n << "\"";
+      groups_of_name[n].push_back(g.first);
+    }
+    o << ")\n";
+  }
+
+  for(const auto& [name, groups]: groups_of_name){
+    const auto& n = jl_identifier(name);
+    o << "\nfunction " << n << "(args...)\n"
+      << "    (";
+    const char* sep = "";
+    for(const auto& g: groups){
+      o << sep << "__wrapit_load_" << g << "()";
+      sep = " | ";
+    }
+    o << ") || throw(MethodError(" << n << ", args))\n"
+      << "    Base.invokelatest(" << n << ", args...)\n"
+      << "end\n";
+  }
+
+  return o;
+}
+
 void
 CodeTree::visit_class(CXCursor cursor){
 
@@ -1231,8 +2218,9 @@ CodeTree::visit_class(CXCursor cursor){
     }
   }
 
-  if(has_cursor(visited_classes_, cursor)) return;
+  if(visited_classes_index_.find(cursor) >= 0) return;
 
+  visited_classes_index_.add(cursor, visited_classes_.size());
   visited_classes_.push_back(cursor);
 
   const auto& kind = clang_getCursorKind(cursor);
@@ -1270,45 +2258,9 @@ CodeTree::visit_class(CXCursor cursor){
 
 bool
 CodeTree::in_veto_list(const std::string signature) const{
-  bool r = false;
-  for(const auto& v: veto_list_){
-    if(v.size() == 0) continue;
-    decltype(veto_list_)::size_type ifirst = 0;
-
-    bool effect = true;
-    if(v[ifirst] == '+'){ //unveto
-      //+ prefix allows to undo a veto (e.g. from a regex)
-      //the last directive line has the last word.
-      effect = false;
-      ++ifirst;
-    } else if(v[ifirst] == '-'){//veto, the default
-      ++ifirst;
-    }
-
-    if(v.size() <= ifirst) continue;
-
-    if(v[ifirst] == '/'){ //regex
-      if(v[v.size()-1] != '/'){
-        std::cerr << "ERROR: syntax error in the veto file: missing an ending"
-          "slash on a line starting with a slash (/).\n";
-        exit(1);
-      }
-      auto re_ = v.substr(ifirst + 1, v.size() - 2 - ifirst);
-      if(verbose > 5) std::cerr << "Debug: Comparing " << signature
-                                << " with grep-like regular expression "
-                                << re_ << "\n";
-      std::regex re(re_, std::regex_constants::basic);
-      if(std::regex_match(signature, re)){
-        r = effect;
-        break;
-      }
-    } else{
-      if(v.substr(ifirst) == signature){
-        r = effect;
-        break;
-      }
-    }
-  }
+  static Profiler::Counter prof_counter("hot path", "veto matching");
+  Profiler::Scope prof(prof_counter);
+  bool r = veto_list_.vetoed(signature);
 
   if(verbose > 1) std::cerr << __FUNCTION__ << "("  << signature << ") -> " << r << "\n";
 
@@ -1704,7 +2656,7 @@ CodeTree::register_type(const CXType& type, int* pItype, int* pIenum){
     } else if(type0.kind == CXType_Enum){
       auto it = std::find_if(enums_.begin(), enums_.end(),
                              [c](const TypeRcd& t){
-                               return clang_equalCursors(t.cursor, c);
+                               return CursorIndex::same_declaration(t.cursor, c);
                              });
 
       if(it == enums_.end()){
@@ -1869,18 +2821,18 @@ CodeTree::visit_member_function(CXCursor cursor){
   if(verbose > 3) std::cerr << __FUNCTION__ << "(" << cursor << ")\n";
 
   TypeRcd* pTypeRcd = find_class_of_method(cursor);
-  
-  FunctionWrapper wrapper(cxx_to_julia_, MethodRcd(cursor), pTypeRcd, type_map_, cxxwrap_version_);
+
+  const std::string& sig = signature(cursor, pTypeRcd);
 
   //FIXME: handle the case where the method is defined in the parent class
   // => would need to define a Julia method that will throw an exception
   //This is not handled either when the access is restricted.
   if(is_method_deleted(cursor)){
-    if(verbose > 1) std::cerr << wrapper.signature() << " is deleted.\n"; //"Method " << cursor << " is deleted.\n";
+    if(verbose > 1) std::cerr << sig << " is deleted.\n"; //"Method " << cursor << " is deleted.\n";
     std::stringstream buf;
     buf << pTypeRcd->type_name << " & " << pTypeRcd->type_name << "::operator=(const " << pTypeRcd->type_name << " &)";
     if(verbose>1) std::cerr << "\tcompared with " << buf.str() << " to check if copy operator must be marked as deleted.\n";
-    if(pTypeRcd && wrapper.signature() == buf.str()/*str(clang_getCursorSpelling(cursor)) == "operator="*/){
+    if(pTypeRcd && sig == buf.str()/*str(clang_getCursorSpelling(cursor)) == "operator="*/){
       if(verbose > 3){
         std::cerr << "Mark copy contructor of class " << pTypeRcd->type_name << " as deleted.\n";
       }
@@ -1890,11 +2842,11 @@ CodeTree::visit_member_function(CXCursor cursor){
     return;
   }
 
-  if(in_veto_list(wrapper.signature())){
-    //  if(std::find(veto_list_.begin(), veto_list_.end(), wrapper.signature()) != veto_list_.end()){
-    vetoed_methods_.insert(wrapper.signature());
+  if(in_veto_list(sig)){
+    //  if(std::find(veto_list_.begin(), veto_list_.end(), sig) != veto_list_.end()){
+    vetoed_methods_.insert(sig);
     if(verbose > 0){
-      std::cerr << "Info: " << "func " << wrapper.signature() << " vetoed\n";
+      std::cerr << "Info: " << "func " << sig << " vetoed\n";
     }
     return ;
   }
@@ -1919,7 +2871,7 @@ CodeTree::visit_member_function(CXCursor cursor){
       //method wrapped only if all argument and return types can be wrapped
       dowrap = !missing_some_type && !funcptr_returntype;
       if(funcptr_returntype && verbose > 0){
-        std::cerr << "Wrapper of function " << wrapper.signature()
+        std::cerr << "Wrapper of function " << sig
                   << " skipped because it returns a function pointer.\n";
       }
 
@@ -1964,29 +2916,16 @@ CodeTree::disable_owner_mirror(CXCursor cursor){
 TypeRcd*
 CodeTree::find_class_of_method(const CXCursor& method){
   const auto& myClass = clang_getCursorSemanticParent(method);
-
-  for(auto& t: types_){
-    if(clang_equalCursors(t.cursor, myClass)){
-      return &t;
-    }
-  }
-  return nullptr;
+  int i = find_type_index(myClass);
+  return i < 0 ? nullptr : &types_[i];
 }
 
 bool CodeTree::has_type(CXCursor cursor) const{
-  for(const auto& x: types_){
-    return clang_equalCursors(cursor, x.cursor);
-  }
-  return false;
+  return find_type_index(cursor) >= 0;
 }
 
 bool CodeTree::has_type(const std::string& t) const{
-  for(const auto& x: types_){
-    //    const auto& t2 = clang_getCursorType(x.cursor);
-    //return str(clang_getTypeSpelling(t2)) == t;
-    if(x.type_name == t) return true;
-  }
-  return false;
+  return find_type_index(t) >= 0;
 }
 
 bool
@@ -2007,8 +2946,7 @@ CodeTree::inform_missing_types(std::vector<CXType> missing_types,
   };
 
   if(verbose > 0){
-    std::string funcname =  FunctionWrapper(cxx_to_julia_, methodRcd, classRcd,
-                                            type_map_, cxxwrap_version_).signature();
+    std::string funcname =  signature(methodRcd.cursor, classRcd);
     std::cerr << "Warning: missing definition of type "
               << (missing_types.size() > 1 ? "s" : "")
               << " "
@@ -2021,7 +2959,7 @@ CodeTree::inform_missing_types(std::vector<CXType> missing_types,
   return true;
 }
 
-CXToken* CodeTree::next_token(CXSourceLocation loc) const{
+CXToken* CodeTree::next_token(CXTranslationUnit unit, CXSourceLocation loc) const{
   CXToken* tok = nullptr;
   CXFile file;
   unsigned offset;
@@ -2029,8 +2967,8 @@ CXToken* CodeTree::next_token(CXSourceLocation loc) const{
   while(!tok){
     clang_getSpellingLocation(loc, nullptr, nullptr, nullptr, &offset);
     if(offset == 0) break; //loc of file reached => roll over
-    loc = clang_getLocationForOffset(unit_, file, offset + 1);
-    tok = clang_getToken(unit_, loc);
+    loc = clang_getLocationForOffset(unit, file, offset + 1);
+    tok = clang_getToken(unit, loc);
   }
   return tok;
 }
@@ -2042,15 +2980,16 @@ CXSourceRange CodeTree::function_decl_range(const CXCursor& cursor) const{
   CXSourceLocation end = clang_getRangeEnd (range);
   CXFile file;
   clang_getSpellingLocation (end, &file, nullptr, nullptr, nullptr);
+  auto unit = clang_Cursor_getTranslationUnit(cursor);
   std::string s;
   while(s != ";" && s != "{"){
-    CXToken* tok = next_token(end);
+    CXToken* tok = next_token(unit, end);
     if(tok==nullptr) break;
 
-    s = str(clang_getTokenSpelling (unit_, *tok));
-    range = clang_getTokenExtent (unit_, *tok);
+    s = str(clang_getTokenSpelling (unit, *tok));
+    range = clang_getTokenExtent (unit, *tok);
     end = clang_getRangeEnd(range);
-    clang_disposeTokens(unit_, tok, 1);
+    clang_disposeTokens(unit, tok, 1);
   }
 
   return clang_getRange(start, end);
@@ -2058,7 +2997,7 @@ CXSourceRange CodeTree::function_decl_range(const CXCursor& cursor) const{
 
 
 bool CodeTree::is_method_deleted(CXCursor cursor) const{
-  return ::is_method_deleted(unit_, cursor);
+  return ::is_method_deleted(clang_Cursor_getTranslationUnit(cursor), cursor);
 }
 
 void
@@ -2178,9 +3117,8 @@ CodeTree::visit_field_or_global_variable(CXCursor cursor){
       }
       return;
     }
-    auto rcd = std::find_if(types_.begin(), types_.end(),
-                            [&](auto a){ return clang_equalCursors(a.cursor, clazz); });
-    if(rcd == types_.end()){
+    int ircd = find_type_index(clazz);
+    if(ircd < 0){
       std::cerr << "Warning: field " << cursor << " of class "
                 << clazz << " found at "
                 << clang_getCursorLocation(cursor)
@@ -2191,10 +3129,9 @@ CodeTree::visit_field_or_global_variable(CXCursor cursor){
     auto type = clang_getCursorType(cursor);
     bool rc  = register_type(type);
     if(!rc) types_missing_def_.insert(fully_qualified_name(base_type(type)));
-    //call to register_type can modify types_ and invalidate rcd,
-    rcd = std::find_if(types_.begin(), types_.end(),
-                       [&](auto a){ return clang_equalCursors(a.cursor, clazz); });
-    rcd->fields.push_back(cursor);
+    //call to register_type can modify types_, the record must be
+    //accessed by index.
+    types_[ircd].fields.push_back(cursor);
   } else if(kind == CXCursor_VarDecl){
     auto type = clang_getCursorType(cursor);
     bool rc  = register_type(type);
@@ -2217,13 +3154,8 @@ CodeTree::visit_class_template_specialization(CXCursor cursor){
 
   const auto& type = clang_getCursorType(cursor);
 
-  TypeRcd* pTypeRcd = nullptr;
-  for(auto& r: types_){
-    if(clang_equalCursors(r.cursor, specialized_cursor)){
-      pTypeRcd =  &r;
-      break;
-    }
-  }
+  int iTypeRcd = find_type_index(specialized_cursor);
+  TypeRcd* pTypeRcd = iTypeRcd < 0 ? nullptr : &types_[iTypeRcd];
 
   if(!pTypeRcd){
     std::cerr << "Warning: specialization found at " << clang_getCursorLocation(cursor)
@@ -2348,15 +3280,22 @@ bool CodeTree::fromMainFiles(const CXCursor& cursor) const{
   const auto& loc = clang_getCursorLocation(cursor);
   CXFile file;
   clang_getFileLocation(loc, &file, nullptr, nullptr, nullptr);
-  //FIXME: stores files as CXFile to prevent conversions and allocations
-  auto fname = fs::canonical(fs::path(str(clang_getFileName(file)))).string();
-  bool result = std::find(files_to_wrap_fullpaths_.begin(), files_to_wrap_fullpaths_.end(), fname)
-    != files_to_wrap_fullpaths_.end();
 
+  //The decision is cached per file, to resolve the path of each
+  //file only once.
+  auto it = main_file_cache_.find(file);
+  if(it == main_file_cache_.end()){
+    auto fname = fs::canonical(fs::path(str(clang_getFileName(file)))).string();
+    bool result = std::find(files_to_wrap_fullpaths_.begin(), files_to_wrap_fullpaths_.end(), fname)
+      != files_to_wrap_fullpaths_.end();
+    it = main_file_cache_.emplace(file, result).first;
+  }
+
+  const bool result = it->second;
 
   if(verbose > 3) std::cerr << __FUNCTION__ << "(" << cursor << ") -> "
                             << result
-                            << " (file defined in " << fname << ")"
+                            << " (file defined in " << clang_getFileName(file) << ")"
                             << "\n";
 
   return result;
@@ -2381,6 +3320,25 @@ CXChildVisitResult CodeTree::visit(CXCursor cursor, CXCursor parent,
   //if(kind != CXCursor_Constructor && !tree.is_to_visit(cursor)) return CXChildVisit_Continue;
   if(!tree.is_to_visit(cursor)) return CXChildVisit_Continue;
 
+  if(tree.multi_unit_visit_ && !tree.visit_once_across_units(cursor)){
+    return CXChildVisit_Continue;
+  }
+
+  //visit time accumulated per header file, for the declarations
+  //at namespace level
+  std::unique_ptr<Profiler::Scope> prof;
+  if(Profiler::instance().enabled()){
+    const auto parent_kind = clang_getCursorKind(parent);
+    if(parent_kind == CXCursor_TranslationUnit || parent_kind == CXCursor_Namespace){
+      CXFile file = nullptr;
+      clang_getFileLocation(clang_getCursorLocation(cursor), &file,
+                            nullptr, nullptr, nullptr);
+      prof = std::make_unique<Profiler::Scope>("header", file ?
+                                               str(clang_getFileName(file))
+                                               : std::string("<built-in>"));
+    }
+  }
+
   if(verbose > 1) std::cerr << "visiting " << clang_getCursorLocation(cursor)
                             << "\t cursor " << cursor
                             << " of kind " << kind
@@ -2429,9 +3387,49 @@ CXChildVisitResult CodeTree::visit(CXCursor cursor, CXCursor parent,
               << " at " << clang_getCursorLocation(cursor)
               << " of kind " << clang_getCursorKindSpelling(kind) << " skipped.\n";
   }
-  return CXChildVisit_Continue;
-}
+  return CXChildVisit_Continue;
+}
+
+
+bool CodeTree::visit_once_across_units(const CXCursor& cursor){
+  const auto& kind = clang_getCursorKind(cursor);
+
+  //Namespaces are visited in every unit, for their contents. The
+  //declaration kinds visit() currently ignores (typedefs, type aliases,
+  //using declarations, partial specializations) are tracked too, to
+  //keep a single visit if they get handled.
+  bool is_decl_to_track = false;
+  if(kind == CXCursor_ClassDecl || kind == CXCursor_StructDecl
+     || kind == CXCursor_ClassTemplate || kind == CXCursor_EnumDecl
+     || kind == CXCursor_ClassTemplatePartialSpecialization){
+    //forward declarations share the USR of the definition
+    //and must not hide it:
+    is_decl_to_track = clang_isCursorDefinition(cursor);
+  } else if(kind == CXCursor_FunctionDecl || kind == CXCursor_VarDecl
+            || kind == CXCursor_FunctionTemplate
+            || kind == CXCursor_TypedefDecl || kind == CXCursor_TypeAliasDecl
+            || kind == CXCursor_TypeAliasTemplateDecl
+            || kind == CXCursor_UsingDeclaration){
+    is_decl_to_track = true;
+  }
+
+  if(!is_decl_to_track) return true;
+
+  const auto& usr = str(clang_getCursorUSR(cursor));
+  if(usr.size() == 0) return true;
+
+  if(usrs_of_previous_units_.count(usr) > 0){
+    if(verbose > 2){
+      std::cerr << "Info: " << cursor << " defined in "
+                << clang_getCursorLocation(cursor)
+                << " already visited in a previous translation unit.\n";
+    }
+    return false;
+  }
 
+  usrs_of_current_unit_.insert(usr);
+  return true;
+}
 
 std::string CodeTree::resolve_include_path(const std::string& fname){
   fs::path p(fname);
@@ -2476,15 +3474,13 @@ CodeTree::parse(){
 
   auto header_file_name = std::string("jl") + module_name_ + ".h";
   header_file_path_ = join_paths(out_cxx_dir_,  header_file_name);
-  FileTimeRestorer timerestore(header_file_path_);
-
-  std::ofstream header_file(header_file_path_, out_open_mode_);
-  if(header_file.tellp() != 0){
+  if(is_in_the_way(header_file_path_)){
     std::cerr << "File " << header_file_path_
               << " is in the way. Remove it or use the --force actions "
       "to disable the check.\n";
     return false;
   }
+  BufferedFile header_file(header_file_path_);
 
   auto macro = fname2macro(header_file_name);
   
@@ -2505,8 +3501,8 @@ CodeTree::parse(){
   }
 
   header_file << "#endif //" << macro << " not defined\n";
-  header_file.close();
-  timerestore.settimestamp();
+  //written before the parsing, which includes it
+  if(!header_file.close()) return false;
 
   index_ = clang_createIndex(0, 0);
 
@@ -2535,13 +3531,29 @@ CodeTree::parse(){
   std::string mfopt;
   if(cmake_.size() > 0){
     //exit program if file is in the way and force mode is disabled
-    checked_open(cmake_).close();
+    if(is_in_the_way(cmake_)){
+      std::cerr << "File " << cmake_ << " in the way. Remove it or use the --force option.\n";
+      exit(1);
+    }
     mfopt = std::string("-MF").append(cmake_);
 
     opts.push_back("-MMD");
     opts.push_back(mfopt.c_str());
   }
 
+  const bool several_units = n_parse_units_ > 1 && files_to_wrap_.size() > 1;
+
+  std::string ast_cache_base;
+  if(pch_cache_dir_.size() > 0){
+    if(several_units){
+      std::cerr << "Warning: the AST cache (pch_cache_dir) is not supported "
+        "when the input headers are parsed in several translation units "
+        "(n_parse_units > 1) and will not be used.\n";
+    } else{
+      ast_cache_base = join_paths(pch_cache_dir_, ast_cache_key(opts));
+    }
+  }
+
   if(verbose > 1){
     //Enable clang verbose option
     opts.push_back("-v");
@@ -2553,11 +3565,25 @@ CodeTree::parse(){
     std::cerr << "\n";
   }
 
+  if(several_units){
+    return parse_in_several_units(opts, mfopt);
+  }
+
+  CXTranslationUnit unit = nullptr;
+  if(ast_cache_base.size() > 0){
+    unit = load_cached_ast(ast_cache_base);
+  }
+
+  const bool ast_from_cache = (unit != nullptr);
 
-  CXTranslationUnit unit = clang_parseTranslationUnit(index_, header_file_path_.c_str(),
-                                                      opts.data(), opts.size(),
-                                                      nullptr, 0,
-                                                      CXTranslationUnit_SkipFunctionBodies);
+  if(!ast_from_cache){
+    unsigned parse_flags = CXTranslationUnit_SkipFunctionBodies;
+    if(ast_cache_base.size() > 0) parse_flags |= CXTranslationUnit_ForSerialization;
+    Profiler::Scope prof("phase", "clang parse");
+    unit = clang_parseTranslationUnit(index_, header_file_path_.c_str(),
+                                      opts.data(), opts.size(),
+                                      nullptr, 0, parse_flags);
+  }
   unit_ = unit;
 
   diagnose(header_file_path_.c_str(), unit);
@@ -2567,7 +3593,11 @@ CodeTree::parse(){
     exit(-1);
   }
 
-  if(!isASTvalid(unit)){
+  if(isASTvalid(unit)){
+    if(ast_cache_base.size() > 0 && !ast_from_cache){
+      save_ast_to_cache(ast_cache_base);
+    }
+  } else{
     if(ignore_parsing_errors_){
       std::cerr << "Warning: code generation forced by the --ignore-parsing-errors "
         "option. The generated code will likely be invalid. Common issue is "
@@ -2578,20 +3608,209 @@ CodeTree::parse(){
     }
   }
 
+  visit_unit(unit);
+  return true;
+}
+
+void
+CodeTree::visit_unit(CXTranslationUnit unit){
   const auto&  cursor = clang_getTranslationUnitCursor(unit);
 
   if(verbose > 1) std::cerr << "Calling clang_visitChildren(" << cursor
                             << ", CodeTree::visit, &data) from "
                             << __FUNCTION__ << "\n";
 
+  auto t0 = std::chrono::steady_clock::now();
+  auto nfiles0 = main_file_cache_.size();
+
+  Profiler::Scope prof("phase", "AST visit");
   clang_visitChildren(cursor, CodeTree::visit, this);
+
+  if(verbose > 0){
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+    std::cerr << "Info: AST visit time: " << dt.count() << " s, "
+              << (main_file_cache_.size() - nfiles0)
+              << " distinct source files traversed.\n";
+  }
+}
+
+
+bool
+CodeTree::parse_in_several_units(const std::vector<const char*>& opts,
+                                 const std::string& mfopt){
+
+  //Splits the input headers in contiguous groups, each group
+  //being included from its own header file
+  const unsigned nunits = std::min<size_t>(n_parse_units_, files_to_wrap_.size());
+  std::vector<std::string> unit_headers(nunits);
+  std::vector<std::string> unit_mfopts(nunits);
+  std::vector<std::string> unit_deps(nunits);
+
+  for(unsigned k = 0; k < nunits; ++k){
+    std::stringstream buf;
+    buf << "jl" << module_name_ << "_unit" << k << ".h";
+    unit_headers[k] = join_paths(out_cxx_dir_, buf.str());
+    BufferedFile f(unit_headers[k]);
+    for(const auto& fname: extra_headerss_){
+      f << "#include \"" << fname << "\"\n";
+    }
+    const size_t first = k * files_to_wrap_.size() / nunits;
+    const size_t last = (k + 1) * files_to_wrap_.size() / nunits;
+    for(size_t i = first; i < last; ++i){
+      f << "#include \"" << files_to_wrap_[i] << "\"\n";
+    }
+    f.close();
+    if(mfopt.size() > 0){
+      unit_deps[k] = cmake_ + "." + std::to_string(k);
+      unit_mfopts[k] = std::string("-MF").append(unit_deps[k]);
+    }
+  }
+
+  //Parses the units on a pool of njobs_ threads, using one clang index
+  //per unit.
+  std::vector<CXIndex> indices(nunits, nullptr);
+  std::vector<CXTranslationUnit> units(nunits, nullptr);
+  std::atomic<unsigned> next_unit(0);
+  auto worker = [&](){
+    for(unsigned k = next_unit++; k < nunits; k = next_unit++){
+      std::vector<const char*> unit_opts(opts);
+      for(auto& o: unit_opts){
+        if(mfopt.size() > 0 && o == mfopt.c_str()) o = unit_mfopts[k].c_str();
+      }
+      Profiler::Scope prof("phase", "clang parse of unit " + std::to_string(k));
+      indices[k] = clang_createIndex(0, 0);
+      units[k] = clang_parseTranslationUnit(indices[k], unit_headers[k].c_str(),
+                                            unit_opts.data(), unit_opts.size(),
+                                            nullptr, 0,
+                                            CXTranslationUnit_SkipFunctionBodies);
+    }
+  };
+
+  const unsigned nthreads = std::max(1u, std::min(njobs_, nunits));
+  if(verbose > 0){
+    std::cerr << "Info: parsing the input headers in " << nunits
+              << " translation units with " << nthreads << " threads.\n";
+  }
+
+  std::vector<std::thread> threads;
+  for(unsigned i = 1; i < nthreads; ++i) threads.emplace_back(worker);
+  worker();
+  for(auto& t: threads) t.join();
+
+  unit_ = units[0];
+  index_ = indices[0];
+  extra_units_.assign(units.begin() + 1, units.end());
+  extra_indices_.assign(indices.begin() + 1, indices.end());
+
+  bool valid = true;
+  for(unsigned k = 0; k < nunits; ++k){
+    diagnose(unit_headers[k].c_str(), units[k]);
+    if(units[k] == nullptr){
+      std::cerr << "Unable to parse " << unit_headers[k] << ". Quitting.\n";
+      exit(-1);
+    }
+    valid = isASTvalid(units[k]) && valid;
+  }
+
+  if(mfopt.size() > 0){
+    merge_dependency_files(unit_deps, unit_headers);
+  }
+
+  //The headers are not needed anymore, their contents being in the ASTs
+  for(const auto& h: unit_headers){
+    std::error_code ec;
+    fs::remove(h, ec);
+  }
+
+  if(!valid){
+    if(ignore_parsing_errors_){
+      std::cerr << "Warning: code generation forced by the --ignore-parsing-errors "
+        "option. The generated code will likely be invalid. Common issue is "
+        "some original data types changed into int.\n";
+    } else{
+      //note: error messages already displayed by isASTvalid().
+      return false;
+    }
+  }
+
+  //The units are visited sequentially, in the order of the input
+  //headers. Declarations from headers included in several units are
+  //visited only in the first one.
+  multi_unit_visit_ = true;
+  for(const auto& unit: units){
+    visit_unit(unit);
+    usrs_of_previous_units_.insert(usrs_of_current_unit_.begin(),
+                                   usrs_of_current_unit_.end());
+    usrs_of_current_unit_.clear();
+  }
+  multi_unit_visit_ = false;
+
   return true;
 }
 
+void
+CodeTree::merge_dependency_files(const std::vector<std::string>& fnames,
+                                 const std::vector<std::string>& unit_headers) const{
+  //Dependency files are in the make format, "target: dep1 dep2 ...",
+  //with lines continued by a backslash.
+  //The merged file uses header_file_path_ for the target and as first
+  //dependency in place of the unit headers, as expected by generate_cxx().
+  std::vector<std::string> deps;
+  std::set<std::string> known(unit_headers.begin(), unit_headers.end());
+  known.insert(header_file_path_);
+
+  for(const auto& fname: fnames){
+    std::ifstream f(fname);
+    std::string content((std::istreambuf_iterator<char>(f)),
+                        std::istreambuf_iterator<char>());
+    f.close();
+    std::error_code ec;
+    fs::remove(fname, ec);
+
+    std::string token;
+    bool target_passed = false;
+    auto flush = [&](){
+      if(token.empty()) return;
+      if(!target_passed){
+        target_passed = (token.back() == ':');
+      } else if(known.insert(token).second){
+        deps.push_back(token);
+      }
+      token.clear();
+    };
+
+    for(size_t i = 0; i < content.size(); ++i){
+      char c = content[i];
+      if(c == '\\' && i + 1 < content.size()){
+        if(content[i+1] == '\n'){ //line continuation
+          flush();
+          ++i;
+        } else{ //escaped character
+          token += c;
+          token += content[++i];
+        }
+      } else if(isspace(c)){
+        flush();
+      } else{
+        token += c;
+      }
+    }
+    flush();
+  }
+
+  std::ofstream o(cmake_);
+  o << header_file_path_ << ": " << header_file_path_;
+  for(const auto& d: deps){
+    o << " \\\n  " << d;
+  }
+  o << "\n";
+}
 
 CodeTree::~CodeTree(){
   if(unit_) clang_disposeTranslationUnit(unit_);
   if(index_) clang_disposeIndex(index_);
+  for(auto& u: extra_units_) if(u) clang_disposeTranslationUnit(u);
+  for(auto& i: extra_indices_) if(i) clang_disposeIndex(i);
 
 }
 
@@ -2627,6 +3846,9 @@ std::ostream& CodeTree::report(std::ostream& o){
   if(type_dependencies_.isCyclic()){
     o << "bad. Type dependencies have at least one cycle."
       " THIS CAN LEAD TO \"No factory\" ERROR WHEN LOADING THE WRAPPER MODULE.\n";
+    for(const auto& cycle: type_dependencies_.cycles()){
+      o << "  Cycle: " << dependency_cycle_str(cycle) << "\n";
+    }
   } else{
     o << "ok. No dependency cycle.\n";
   }
@@ -2663,10 +3885,7 @@ std::ostream& CodeTree::report(std::ostream& o){
   o << "\n";
 
   for(const auto& cursor: auto_vetoed_methods_){
-    auto sig = FunctionWrapper(cxx_to_julia_, MethodRcd(cursor),
-                               find_class_of_method(cursor),
-                               type_map_,
-                               cxxwrap_version_).signature();
+    auto sig = signature(cursor, find_class_of_method(cursor));
     o << sig << "\n";
   }
 
@@ -2723,6 +3942,11 @@ std::ostream& CodeTree::report(std::ostream& o){
   }
   o << "\n";
 
+  o << "\nNumber of lambda functions generated for the methods (method_wrapper_strategy = "
+    << (method_wrapper_strategy_ == method_wrapper_strategy_t::lambdas ?
+        "lambdas" : "ptr_adapter")
+    << "): " << nwraps_.lambdas << "\n";
+
   o << "\nList of wrapped classes:\n\n";
   for(const auto& t: types_){
     if(t.to_wrap){
@@ -2741,6 +3965,11 @@ std::ostream& CodeTree::report(std::ostream& o){
     o << p.first << "\n\t" << p.second << "\n";
   }
   
+  std::vector<std::string> isbits_type_names;
+  for(const auto& t: isbits_types_) isbits_type_names.push_back(t.type_name);
+  list_for_report(o, "List of types mapped to Julia isbits structs",
+                  isbits_type_names);
+
   list_for_report(o, "List of vetoed types", vetoed_types_);
   list_for_report(o, "List of vetoed enums", vetoed_enums_);
   list_for_report(o, "List of vetoed methods", vetoed_methods_);
@@ -2762,15 +3991,14 @@ std::ostream& CodeTree::report(std::ostream& o){
 void CodeTree::reset_wrapped_methods(){
   wrapped_methods_.clear();
   wrapped_methods_after_map_.clear();
+  wrapped_methods_after_map_set_.clear();
 }
 
 bool CodeTree::add_wrapped_method(const std::string signature_before_type_map,
                                   const std::string signature_after_type_map,
                                   std::string* found_signature){
-  auto it = std::find(wrapped_methods_after_map_.begin(),
-                       wrapped_methods_after_map_.end(),
-                      signature_after_type_map);
-  if(wrapped_methods_after_map_.end() == it){
+  auto [it, inserted] = wrapped_methods_after_map_set_.insert(signature_after_type_map);
+  if(inserted){
     wrapped_methods_.push_back(signature_before_type_map);
     wrapped_methods_after_map_.push_back(signature_after_type_map);
      if(found_signature) *found_signature = "";
@@ -2809,22 +4037,41 @@ void CodeTree::preprocess(){
     mainFileOnly_ = savedMainFileOnly;
   }
 
+  //Add user defined dependencies
+  for(const auto& dep: class_order_constraints_){
+    int i1 = find_type_index(dep.first);
+    int i2 = find_type_index(dep.second);
+
+    if(i1 >= 0 && i2 >= 0){
+      type_dependencies_.preceeds(i1, i2);
+      if(verbose > 1) std::cerr << "Dependency \"" << dep.second << " requires " << dep.first
+                                << "\" added.\n";
+    } else{
+      if(verbose>0){
+        std::cerr << "Warning: class dependency "
+                  << dep.first << " < " << dep.second
+                  << " not used.";
+        if(i1 < 0) std::cerr << " No " << dep.first << " class.";
+        if(i2 < 0) std::cerr << " No " << dep.second << " class.";
+        std::cerr << "\n";
+      }
+    }
+  }
+
   //Add child -> parent class dependencies
   for(unsigned iChild = 0; iChild < types_.size(); ++iChild){
     auto [ parent, extra_parents ] = getParentClassesForWrapper(types_[iChild].cursor);
     //dependency is relevant for the main parent only, ignore the extra parents.
     if(!clang_Cursor_isNull(parent)){
-      for(unsigned iParent = 0;  iParent < types_.size(); ++iParent){
-        if(clang_equalCursors(parent, types_[iParent].cursor)){
-          //Parent must be declared before its child:
-          if(verbose > 4){
-            std::cerr << "Debug: "
+      for(unsigned iParent: type_cursor_index_.find_all(parent)){
+        //Parent must be declared before its child:
+        if(verbose > 4){
+          std::cerr << "Debug: "
                     << types_[iParent].type_name
-                      << " must be declared before its child "
-                      << types_[iChild].type_name << "\n";
-          }
-          type_dependencies_.preceeds(iParent, iChild);
+                    << " must be declared before its child "
+                    << types_[iChild].type_name << "\n";
         }
+        type_dependencies_.preceeds(iParent, iChild);
       }
     }
 
@@ -2838,46 +4085,20 @@ void CodeTree::preprocess(){
 
         const auto& paramType = types_[iChild].template_parameter_combinations[iCombi].at(iParam);
 
-        for(unsigned jType = 0; jType < types_.size(); ++jType){
-          if(types_[jType].type_name == paramType){
-            if(verbose > 4){
-              std::cerr << "Debug: "
-                        << paramType
-                        << " must be declared before the class "
-                        << types_[iChild].type_name
-                        << " that uses it as a template parameter.\n";
-            }
-            type_dependencies_.preceeds(jType, iChild);
-            break;
+        int jType = find_type_index(paramType);
+        if(jType >= 0){
+          if(verbose > 4){
+            std::cerr << "Debug: "
+                      << paramType
+                      << " must be declared before the class "
+                      << types_[iChild].type_name
+                      << " that uses it as a template parameter.\n";
           }
-        }//next iParamType
+          type_dependencies_.preceeds(jType, iChild);
+        }
       }//next paramType
     }//next iCombi
 
-
-    //Add user defined dependencies
-    for(const auto& dep: class_order_constraints_){
-      auto it1 = std::find_if(types_.begin(), types_.end(),
-                              [dep](const auto& x){ return x.type_name == dep.first;});
-      auto it2 = std::find_if(types_.begin(), types_.end(),
-                              [dep](const auto& x){ return x.type_name == dep.second;});
-
-      if(it1 != types_.end() && it2 != types_.end()){
-        type_dependencies_.preceeds(it1 - types_.begin(), it2 - types_.begin());
-        if(verbose > 1) std::cerr << "Dependency \"" << dep.second << " requires " << dep.first
-                                << "\" added.\n";
-      } else{
-        if(verbose>0){
-          std::cerr << "Warning: class dependency "
-                    << dep.first << " < " << dep.second
-                    << " not used.";
-          if(it1 == types_.end()) std::cerr << " No " << dep.first << " class.";
-          if(it2 == types_.end()) std::cerr << " No " << dep.second << " class.";
-          std::cerr << "\n";
-        }
-      }
-    }
-
 #ifdef DEFINE_TEMPLATE_METHODS_IN_CTOR
     //Add dependencies of templated classes to the type of their methods
     //argument and return value.
@@ -2892,20 +4113,19 @@ void CodeTree::preprocess(){
           }
           argtype = base_type_(argtype);
           auto argtypename = fully_qualified_name(argtype);
-          if(argtype.kind == CXType_Record){
-            for(unsigned iArgType = 0; iArgType < types_.size(); ++iArgType){
-              if(types_[iArgType].type_name == argtypename){
-                if(verbose > 4){
-                  std::cerr << "Debug: "
-                            << argtypename
-                            << " must be declared before "
-                            << types_[iChild].type_name
-                            << " because it is used in a method of this "
-                            << " templated class."
-                            << "\n";
-                }
-                type_dependencies_.preceeds(iArgType, iChild);
-              }//types_[iArgType].type_name == argtypename
+          auto itArgType = type_name_index_.find(argtypename);
+          if(argtype.kind == CXType_Record && itArgType != type_name_index_.end()){
+            for(unsigned iArgType: itArgType->second){
+              if(verbose > 4){
+                std::cerr << "Debug: "
+                          << argtypename
+                          << " must be declared before "
+                          << types_[iChild].type_name
+                          << " because it is used in a method of this "
+                          << " templated class."
+                          << "\n";
+              }
+              type_dependencies_.preceeds(iArgType, iChild);
             }//next iArgType
           }//(argtype.kind == CXType_Record
         }//next iarg
@@ -2924,6 +4144,13 @@ void CodeTree::preprocess(){
 
   type_dependencies_.extend(types_.size());
 
+  //types not constrained by the dependencies are ordered by name, for
+  //a generated code independent of the header parsing order
+  std::vector<std::string> type_names;
+  type_names.reserve(types_.size());
+  for(const auto& t: types_) type_names.push_back(t.type_name);
+  type_dependencies_.setKeys(std::move(type_names));
+
   types_sorted_indices_ = type_dependencies_.sortedIndices();
 
   if(verbose > 2){
@@ -2937,19 +4164,198 @@ void CodeTree::preprocess(){
   //add a fake_type to hold global functions and variables
   if(functions_.size() > 0 || vars_.size() > 0){
     types_.emplace_back();
+    index_last_type();
     types_.back().methods = deduplicate_methods(functions_);
     types_.back().fields = vars_;
     types_.back().to_wrap = true;
     types_sorted_indices_.push_back(types_.size() - 1);
   }
 
+  select_isbits_types();
+
+  //Fills the method list caches. The flags are set beforehand as the
+  //cached lists contain copies of the method records.
+  for(auto i: types_sorted_indices_){
+    if(types_[i].to_wrap) types_[i].setStrictNumberTypeFlags(type_map_);
+  }
+  methods_to_wrap_cache_.clear();
+  deduplicated_methods_cache_.clear();
+  for(auto i: types_sorted_indices_){
+    const auto& c = types_[i];
+    if(c.to_wrap && !is_type_vetoed(c.type_name)
+       && (c.type_name.size() == 0
+           || clang_getCursorKind(c.cursor) != CXCursor_ClassTemplate
+           || c.template_parameter_combinations.size() > 0)){
+      get_methods_to_wrap(c);
+    }
+  }
+
+  //uses the method lists for the compilation cost estimates
   update_wrapper_filenames();
+
   if(out_open_mode_ & std::ios_base::app){
     //not overwriting mode (--force option disabled)
     exit_if_wrapper_files_in_the_way();
   }
 }
 
+void CodeTree::select_isbits_types(){
+  isbits_types_.clear();
+  if(isbits_list_.empty()) return;
+
+  std::map<std::string, std::string> checked;
+  for(auto i: types_sorted_indices_){
+    const auto& c = types_[i];
+    if(!c.to_wrap || c.type_name.size() == 0
+       || !isbits_list_.vetoed(c.type_name)
+       || is_type_vetoed(c.type_name)) continue;
+    const auto& reason = add_isbits_type(c.cursor, checked);
+    if(reason.size() > 0 && verbose > 0){
+      std::cerr << "Warning: type " << c.type_name
+                << " of the isbits_types list is wrapped as a regular class: it "
+                << reason << ".\n";
+    }
+  }
+
+  for(const auto& t: isbits_types_){
+    if(verbose > 1){
+      std::cerr << "Info: type " << t.type_name
+                << " mapped to the Julia isbits struct " << t.jl_name << "\n";
+    }
+    auto it = type_name_index_.find(t.type_name);
+    if(it != type_name_index_.end()){
+      for(auto i: it->second) types_[i].to_wrap = false;
+    }
+    if(export_mode_ == export_mode_t::all) to_export_.insert(t.jl_name);
+  }
+}
+
+std::string
+CodeTree::add_isbits_type(const CXCursor& cursor,
+                          std::map<std::string, std::string>& checked){
+  const auto& type = clang_getCursorType(cursor);
+  const auto& type_name = fully_qualified_name(cursor);
+
+  auto it = checked.find(type_name);
+  if(it != checked.end()) return it->second;
+
+  std::string reason;
+  const auto kind = clang_getCursorKind(cursor);
+  if(kind == CXCursor_UnionDecl){
+    reason = "is a union";
+  } else if((kind != CXCursor_StructDecl && kind != CXCursor_ClassDecl)
+            || clang_Type_getNumTemplateArguments(type) > 0){
+    reason = "is a template";
+  } else if(!clang_isPODType(type)){
+    reason = "is not a POD type";
+  }
+
+  struct data_t {
+    std::vector<CXCursor> fields;
+    std::string reason;
+  } data;
+
+  if(reason.empty()){
+    clang_visitChildren(cursor, [](CXCursor cursor, CXCursor, CXClientData data_){
+      auto& data = *static_cast<data_t*>(data_);
+      const auto& kind = clang_getCursorKind(cursor);
+      const auto& name = str(clang_getCursorSpelling(cursor));
+      if(kind == CXCursor_CXXBaseSpecifier){
+        data.reason = "has a base class";
+      } else if(kind == CXCursor_CXXMethod || kind == CXCursor_Constructor
+                || kind == CXCursor_Destructor){
+        //the methods of the record would not be wrapped
+        data.reason = "declares member functions";
+      } else if(kind == CXCursor_FieldDecl){
+        if(clang_Cursor_isBitField(cursor)){
+          data.reason = "has the bit field " + name;
+        } else if(clang_getCXXAccessSpecifier(cursor) != CX_CXXPublic){
+          data.reason = "has the non-public field " + name;
+        } else{
+          data.fields.push_back(cursor);
+        }
+      }
+      return data.reason.empty() ? CXChildVisit_Continue : CXChildVisit_Break;
+    }, &data);
+    reason = data.reason;
+  }
+
+  if(reason.empty() && data.fields.empty()){
+    //an empty C++ struct has a non-zero size
+    reason = "has no data member";
+  }
+
+  isbits_type_t rcd{type_name, jl_type_name(type_name),
+                    clang_Type_getSizeOf(type), clang_Type_getAlignOf(type), {}};
+
+  for(const auto& f: data.fields){
+    if(reason.size() > 0) break;
+    const auto& fname = str(clang_getCursorSpelling(f));
+    const auto& ftype = clang_getCursorType(f);
+    std::string why;
+    const auto& jl_type = isbits_field_jl_type(ftype, checked, why);
+    //offset in bits, negative on error
+    const auto offset = clang_Cursor_getOffsetOfField(f);
+    if(jl_type.empty()){
+      reason = "has the field " + fname + " of type " + str(clang_getTypeSpelling(ftype))
+        + ", which " + why;
+    } else if(offset < 0 || offset % 8 != 0){
+      reason = "has the field " + fname + " whose offset is not known";
+    } else{
+      rcd.fields.push_back({fname, jl_type, offset / 8});
+    }
+  }
+
+  if(reason.empty() && (rcd.size <= 0 || rcd.align <= 0)){
+    reason = "has a size that is not known";
+  }
+
+  if(reason.empty()) isbits_types_.push_back(std::move(rcd));
+  checked[type_name] = reason;
+  return reason;
+}
+
+std::string
+CodeTree::isbits_field_jl_type(CXType type,
+                               std::map<std::string, std::string>& checked,
+                               std::string& why){
+  type = clang_getCanonicalType(type);
+
+  if(type.kind == CXType_Bool) return "Bool";
+
+  const auto& jl_type = jl_arithmetic_type(type);
+  if(jl_type.size() > 0) return jl_type;
+
+  if(type.kind == CXType_ConstantArray){
+    const auto& eltype = isbits_field_jl_type(clang_getArrayElementType(type),
+                                              checked, why);
+    if(eltype.empty()) return eltype;
+    return "NTuple{" + std::to_string(clang_getArraySize(type)) + ", " + eltype + "}";
+  }
+
+  if(type.kind == CXType_Record){
+    const auto& decl = clang_getCursorDefinition(clang_getTypeDeclaration(type));
+    if(clang_Cursor_isNull(decl)){
+      why = "is incomplete";
+      return "";
+    }
+    const auto& name = fully_qualified_name(decl);
+    if(!isbits_list_.vetoed(name)){
+      why = "is not in the isbits_types list";
+      return "";
+    }
+    const auto& reason = add_isbits_type(decl, checked);
+    if(reason.size() > 0){
+      why = reason;
+      return "";
+    }
+    return jl_identifier(jl_type_name(name));
+  }
+
+  why = "is not supported";
+  return "";
+}
+
 void CodeTree::exit_if_wrapper_files_in_the_way(){
   std::stringstream buf;
   std::string sep;
@@ -3079,6 +4485,162 @@ std::vector<std::string> CodeTree::get_enum_constants(CXCursor cursor) const{
   return v;
 }
 
+std::string
+CodeTree::ast_cache_key(const std::vector<const char*>& opts) const{
+  //The key covers everything the AST depends on apart from the contents
+  //of the included files, which are checked when loading the cache.
+  std::stringstream buf;
+  buf << version << '\0'
+      << str(clang_getClangVersion()) << '\0'
+      << header_file_path_ << '\0';
+  std::ifstream header(header_file_path_);
+  buf << header.rdbuf() << '\0';
+  for(const auto& opt: opts){
+    buf << opt << '\0';
+  }
+  std::vector<unsigned char> md5;
+  md5sum_of_string(md5, buf.str());
+  return md5hex(md5);
+}
+
+CXTranslationUnit
+CodeTree::load_cached_ast(const std::string& base) const{
+  const auto ast_path = base + ".ast";
+  std::ifstream deps(base + ".deps");
+  if(!deps.good() || !fs::exists(ast_path)) return nullptr;
+
+  if(cmake_.size() > 0 && !fs::exists(base + ".d")) return nullptr;
+
+  std::string line;
+  while(std::getline(deps, line)){
+    std::istringstream l(line);
+    uintmax_t size = 0;
+    long long mtime = 0;
+    std::string path;
+    l >> size >> mtime;
+    l.get();
+    std::getline(l, path);
+    uintmax_t cur_size = 0;
+    long long cur_mtime = 0;
+    if(!file_stamp(path, cur_size, cur_mtime)
+       || cur_size != size || cur_mtime != mtime){
+      if(verbose > 0){
+        std::cerr << "Info: file " << path << " changed since the AST cached in "
+                  << ast_path << " was produced. Headers will be parsed again.\n";
+      }
+      return nullptr;
+    }
+  }
+
+  auto unit = clang_createTranslationUnit(index_, ast_path.c_str());
+  if(unit == nullptr){
+    std::cerr << "Warning: failed to load the cached AST " << ast_path
+              << ". Headers will be parsed again.\n";
+    return nullptr;
+  }
+
+  if(cmake_.size() > 0){
+    //the dependency file is produced by the parsing, which is skipped
+    std::error_code ec;
+    fs::copy_file(base + ".d", cmake_, fs::copy_options::overwrite_existing, ec);
+    if(ec){
+      std::cerr << "Failed to write file " << cmake_ << ": " << ec.message() << "\n";
+      exit(1);
+    }
+  }
+
+  if(verbose > 0){
+    std::cerr << "Info: header parsing skipped, AST loaded from " << ast_path << ".\n";
+  }
+
+  return unit;
+}
+
+void
+CodeTree::save_ast_to_cache(const std::string& base) const{
+  std::error_code ec;
+  fs::create_directories(pch_cache_dir_, ec);
+
+  const auto ast_path = base + ".ast";
+  const auto tmp_path = ast_path + ".tmp";
+
+  if(clang_saveTranslationUnit(unit_, tmp_path.c_str(),
+                               clang_defaultSaveOptions(unit_)) != CXSaveError_None){
+    std::cerr << "Warning: failed to save the parsed AST in " << ast_path
+              << ". Caching is disabled for this run.\n";
+    fs::remove(tmp_path, ec);
+    return;
+  }
+
+  //a dependency that cannot be checked would make the cache valid
+  //whatever its changes: the AST is then not cached.
+  std::stringstream deps_buf;
+  for(const auto& path: included_files()){
+    uintmax_t size = 0;
+    long long mtime = 0;
+    if(!file_stamp(path, size, mtime)){
+      std::cerr << "Warning: failed to read the size and modification time of "
+                << path << ". The parsed AST is not cached.\n";
+      fs::remove(tmp_path, ec);
+      fs::remove(base + ".deps", ec);
+      return;
+    }
+    deps_buf << size << " " << mtime << " " << path << "\n";
+  }
+
+  std::ofstream deps(base + ".deps");
+  deps << deps_buf.str();
+  deps.close();
+
+  if(cmake_.size() > 0){
+    fs::copy_file(cmake_, base + ".d", fs::copy_options::overwrite_existing, ec);
+  }
+
+  fs::rename(tmp_path, ast_path, ec);
+  if(ec){
+    std::cerr << "Warning: failed to write " << ast_path << ": " << ec.message() << "\n";
+  } else if(verbose > 0){
+    std::cerr << "Info: parsed AST saved in " << ast_path << ".\n";
+  }
+}
+
+std::vector<std::string>
+CodeTree::included_files() const{
+  std::vector<std::string> files;
+  if(unit_ == nullptr) return files;
+  std::vector<CXTranslationUnit> units = { unit_ };
+  units.insert(units.end(), extra_units_.begin(), extra_units_.end());
+  for(const auto& unit: units){
+    clang_getInclusions(unit, [](CXFile included_file, CXSourceLocation*,
+                                 unsigned, CXClientData data){
+      auto files = static_cast<std::vector<std::string>*>(data);
+      const auto& fname = str(clang_getFileName(included_file));
+      if(std::find(files->begin(), files->end(), fname) == files->end()){
+        files->push_back(fname);
+      }
+    }, &files);
+  }
+  return files;
+}
+
+std::vector<std::string>
+CodeTree::generated_files() const{
+  std::vector<std::string> files;
+  if(header_file_path_.size() > 0) files.push_back(header_file_path_);
+  files.push_back(join_paths(out_cxx_dir_, std::string("jl") + module_name_ + ".cxx"));
+  for(const auto& fname: towrap_type_filenames_set_){
+    files.push_back(join_paths(out_cxx_dir_, fname));
+  }
+  for(const auto& [group, sources]: lib_group_sources_){
+    for(const auto& fname: sources) files.push_back(join_paths(out_cxx_dir_, fname));
+  }
+  files.push_back(join_paths(out_cxx_dir_, "dbg_msg.h"));
+  files.push_back(join_paths(out_cxx_dir_, "Wrapper.h"));
+  files.push_back(join_paths(out_cxx_dir_, "generated_cxx"));
+  if(cmake_.size() > 0) files.push_back(cmake_);
+  return files;
+}
+
 void
 CodeTree::parse_vetoes(const fs::path& fname){
   std::ifstream f(fname.c_str());
@@ -3096,7 +4658,7 @@ CodeTree::parse_vetoes(const fs::path& fname){
     if(line.size() > 0
        && line[0]!='#'
        && !(line[0]=='/' && line[1] =='/')){
-      veto_list_.push_back(line);
+      veto_list_.add(line);
     }
   }
 }
@@ -3110,14 +4672,15 @@ CodeTree::arg_with_default_value(const CXCursor& c) const{
   const auto& range = clang_getCursorExtent(c);
   if(clang_Range_isNull(range)) return false;
 
-  clang_tokenize(unit_, range, &toks, &nToks);
+  auto unit = clang_Cursor_getTranslationUnit(c);
+  clang_tokenize(unit, range, &toks, &nToks);
 
   bool res = false;
   for(unsigned i =0; i < nToks; ++i){
-    const auto& s = str(clang_getTokenSpelling(unit_, toks[i]));
+    const auto& s = str(clang_getTokenSpelling(unit, toks[i]));
     if(s == "=") res = true;
   }
-  clang_disposeTokens(unit_, toks, nToks);
+  clang_disposeTokens(unit, toks, nToks);
 
 
   return res;
@@ -3175,18 +4738,12 @@ CodeTree::add_type(const CXCursor& cursor, bool check){
   const int not_found =  -1;
   int index = not_found;
   if(check){
-    int i = 0;
-    for(const auto& t: types_){
-      if(clang_equalCursors(t.cursor, cursor)){
-        index = i;
-        break;
-      }
-      ++i;
-    }
+    index = find_type_index(cursor);
   }
   if(index == not_found){
     index = types_.size();
     types_.emplace_back(cursor);
+    index_last_type();
     set_type_rcd_ctor_info(types_.back());
   }
 
@@ -3204,6 +4761,117 @@ CodeTree::add_type(const CXCursor& cursor, bool check){
   return index;
 }
 
+void CodeTree::index_last_type(){
+  const unsigned i = types_.size() - 1;
+  type_cursor_index_.add(types_[i].cursor, i);
+  type_name_index_[types_[i].type_name].push_back(i);
+}
+
+int CodeTree::find_type_index(const CXType& type) const{
+  //types are compared with same_type(), that is using
+  //the fully qualified name of the type.
+  for(; n_types_indexed_by_type_ < types_.size(); ++n_types_indexed_by_type_){
+    const auto& t = clang_getCursorType(types_[n_types_indexed_by_type_].cursor);
+    type_fqn_index_.emplace(fully_qualified_name(t), n_types_indexed_by_type_);
+  }
+  auto it = type_fqn_index_.find(fully_qualified_name(type));
+  return it == type_fqn_index_.end() ? -1 : it->second;
+}
+
+unsigned CodeTree::estimate_compile_cost(const TypeRcd& c) const{
+  if(is_type_vetoed(c.type_name)) return 0;
+
+  //Unit: a function registered with jlcxx::Module::method, which leads to
+  //a lambda or a function pointer cast and to a method template
+  //instantiation. Each field or variable leads to a getter and a setter.
+  //The code is instantiated for every specialization of a class template.
+  const bool templated = c.type_name.size() > 0
+    && clang_getCursorKind(c.cursor) == CXCursor_ClassTemplate;
+
+  unsigned cost = 1 //add_type
+    + (c.default_ctor ? 1 : 0)
+    + 2 * c.fields.size();
+
+  //The method wrappers are configured as by method_cxx_decl(), without
+  //generating their code, to count the variants for the default argument
+  //values and for the pointer receivers, and the methods inherited from
+  //the extra parent classes.
+  if(!templated || c.template_parameter_combinations.size() > 0){
+    for(const auto& m: get_methods_to_wrap(c)){
+      FunctionWrapper wrapper(cxx_to_julia_, m, &c, type_map_,
+                              cxxwrap_version_,
+                              templated ? "wrapped" : "",
+                              templated ? "WrappedType" : "",
+                              templated ? 3 : 2, templated);
+      const auto& sig = signature(m.cursor, &c);
+      if(veto_list_.has_line(sig)) continue;
+      if(configure_method_wrapper(wrapper, sig, /*quiet=*/true)){
+        cost += 1; //extern "C" thunk
+      } else{
+        cost += wrapper.estimate_nwrappers();
+      }
+    }
+  }
+
+  //The instantiations induced by jlcxx::stl::apply_stl are much
+  //heavier than a method wrapper
+  const unsigned stl_cost = 20;
+  if(c.stl) cost += stl_cost;
+  if(c.stl_const) cost += stl_cost;
+  if(c.stl_ptr) cost += stl_cost;
+  if(c.stl_const_ptr) cost += stl_cost;
+
+  const auto nspecializations = c.template_parameter_combinations.size();
+  if(nspecializations > 1) cost *= nspecializations;
+
+  return cost;
+}
+
+std::vector<unsigned>
+CodeTree::balanced_file_partition(const std::vector<unsigned>& costs,
+                                  unsigned nfiles) const{
+  //Splits the sequence into nfiles contiguous chunks, keeping the type
+  //order, minimizing the cost of the most expensive chunk. Binary search
+  //on this maximal cost, the feasibility of a given bound being checked
+  //by filling the chunks greedily.
+  auto nchunks = [&](unsigned long long bound){
+    unsigned n = 1;
+    unsigned long long sum = 0;
+    for(auto c: costs){
+      if(sum + c > bound){
+        ++n;
+        sum = 0;
+      }
+      sum += c;
+    }
+    return n;
+  };
+
+  unsigned long long lo = 0, hi = 0;
+  for(auto c: costs){
+    lo = std::max<unsigned long long>(lo, c);
+    hi += c;
+  }
+  while(lo < hi){
+    auto mid = lo + (hi - lo) / 2;
+    if(nchunks(mid) <= nfiles) hi = mid;
+    else lo = mid + 1;
+  }
+
+  std::vector<unsigned> ichunks;
+  ichunks.reserve(costs.size());
+  unsigned ichunk = 0;
+  unsigned long long sum = 0;
+  for(auto c: costs){
+    if(sum + c > lo){
+      ++ichunk;
+      sum = 0;
+    }
+    sum += c;
+    ichunks.push_back(ichunk);
+  }
+  return ichunks;
+}
 
 void CodeTree::update_wrapper_filenames(){
   int ifile = 0;
@@ -3211,15 +4879,46 @@ void CodeTree::update_wrapper_filenames(){
   towrap_type_filenames_.clear();
   towrap_type_filenames_set_.clear();
 
+  //Balanced mode: file index of each class in the order of types_sorted_indices_
+  std::vector<unsigned> balanced_ifiles;
+  if(n_balanced_files_ > 0){
+    std::vector<unsigned> costs;
+    for(auto i: types_sorted_indices_){
+      const auto& c = types_[i];
+      if(c.to_wrap && c.type_name.size() > 0){
+        costs.push_back(estimate_compile_cost(c));
+      }
+    }
+    balanced_ifiles = balanced_file_partition(costs, n_balanced_files_);
+
+    if(verbose > 0 && costs.size() > 0){
+      std::vector<unsigned long long> file_costs(balanced_ifiles.back() + 1);
+      for(unsigned j = 0; j < costs.size(); ++j){
+        file_costs[balanced_ifiles[j]] += costs[j];
+      }
+      std::cerr << "Info: class wrappers distributed in " << file_costs.size()
+                << " files. Estimated compilation cost (number of wrappers) "
+                << "of the lightest and heaviest files: "
+                << *std::min_element(file_costs.begin(), file_costs.end())
+                << ", "
+                << *std::max_element(file_costs.begin(), file_costs.end())
+                << ".\n";
+    }
+  }
+
   for(auto i: types_sorted_indices_){
     auto& c = types_[i];
     if(!c.to_wrap) continue;
-    if(n_classes_per_file_ > 1
+    if(n_balanced_files_ > 0){
+      if(c.type_name.size() > 0){
+        ifile = balanced_ifiles.at(igroupedtype) + 1;
+      }
+    } else if(n_classes_per_file_ > 1
        && (igroupedtype % n_classes_per_file_) == 0){
       ++ifile;
     }
 
-    if(c.type_name.size() == 0 && n_classes_per_file_ != 0){
+    if(c.type_name.size() == 0 && (n_classes_per_file_ != 0 || n_balanced_files_ > 0)){
       //holder of global functions and variables
       towrap_type_filenames_set_.insert("JlGlobals.cxx");
       towrap_type_filenames_.emplace_back("JlGlobals.cxx");
@@ -3228,7 +4927,9 @@ void CodeTree::update_wrapper_filenames(){
 
     ++igroupedtype;
     std::stringstream buf;
-    if(n_classes_per_file_ < 0){
+    if(n_balanced_files_ > 0){
+      buf << "JlClasses_" << std::setfill('0') << std::setw(3) << ifile << ".cxx";
+    } else if(n_classes_per_file_ < 0){
       //FIXME: handle possible name clashes
       buf << "Jl" << std::regex_replace(c.type_name, std::regex("::"), "_") << ".cxx";
     } else if(n_classes_per_file_ == 0){
@@ -3478,6 +5179,7 @@ void CodeTree::set_cxx2cxx_typemap(const std::vector<std::string>& name_map){
                     << "respectively for argument and return types.\n";
         }
         type_map_.add(from, argtype, returntype);
+        signature_cache_.clear();
       } else{
         failed = true;
       }
@@ -3492,6 +5194,36 @@ void CodeTree::set_cxx2cxx_typemap(const std::vector<std::string>& name_map){
   }
 }
 
+std::string
+CodeTree::signature(const CXCursor& cursor, const TypeRcd* pTypeRcd,
+                    bool withconst, bool withstatic, bool aftermap) const{
+  static Profiler::Counter prof_counter("hot path", "signature computation");
+  Profiler::Scope prof(prof_counter);
+  const auto ivariant = SignatureCache::variant(withconst, withstatic, aftermap);
+
+  const auto& usr = str(clang_getCursorUSR(cursor));
+
+  //the class context changes the prefix, including the empty type name
+  //of the global function holder ("::")
+  std::string key;
+  if(usr.size() > 0){
+    key = usr + (pTypeRcd ? ("\n" + pTypeRcd->type_name) : std::string());
+    auto found = signature_cache_.find(key);
+    if(found) return *(*found)[ivariant];
+  }
+
+  FunctionWrapper wrapper(cxx_to_julia_, MethodRcd(cursor), pTypeRcd, type_map_,
+                          cxxwrap_version_);
+  std::array<std::string, 8> sigs;
+  for(unsigned i = 0; i < sigs.size(); ++i){
+    sigs[i] = wrapper.signature(i & 1, i & 2, i & 4);
+  }
+
+  if(usr.size() > 0) signature_cache_.add(key, sigs);
+
+  return sigs[ivariant];
+}
+
 std::vector<MethodRcd>
 CodeTree::deduplicate_methods(const std::vector<MethodRcd>& methods, bool quiet) const{
   struct rcd{
@@ -3502,10 +5234,9 @@ CodeTree::deduplicate_methods(const std::vector<MethodRcd>& methods, bool quiet)
   std::map<std::string, rcd> sigs;
   std::vector<MethodRcd> res;
   for(const auto& m: methods){
-    FunctionWrapper wrapper(cxx_to_julia_, m, nullptr, type_map_, cxxwrap_version_);
     std::string pref = clang_CXXMethod_isStatic(m.cursor) ? "static " : "";
-    std::string mapped_sig    = pref + wrapper.signature(/*cv=*/false, /*map=*/true);
-    std::string notmapped_sig = pref + wrapper.signature(/*cv=*/false, /*map=*/false);
+    std::string mapped_sig    = pref + signature(m.cursor, nullptr, false, false, /*map=*/true);
+    std::string notmapped_sig = pref + signature(m.cursor, nullptr, false, false, /*map=*/false);
     bool isconst = clang_CXXMethod_isConst(m.cursor);
 
     auto it = sigs.find(mapped_sig);
@@ -3541,19 +5272,69 @@ CodeTree::deduplicate_methods(const std::vector<MethodRcd>& methods, bool quiet)
   return res;
 }
 
+int CodeTree::index_of(const TypeRcd& type_rcd) const{
+  //The pointer difference is defined only for two elements of the same
+  //array: the bounds are checked first with std::less, which, contrary to
+  //the built-in operator, gives a total order on all pointers.
+  const TypeRcd* p = &type_rcd;
+  const TypeRcd* first = types_.data();
+  const TypeRcd* last = first + types_.size();
+  std::less<const TypeRcd*> lt;
+  if(lt(p, first) || !lt(p, last)) return -1;
+  return (int)(p - first);
+}
+
+const std::vector<MethodRcd>*
+CodeTree::find_in_method_cache(const method_cache_t& cache,
+                               const TypeRcd& type_rcd, bool quiet) const{
+  int i = index_of(type_rcd);
+  if(i < 0) return nullptr;
+  auto it = cache.find(i);
+  //an entry computed in quiet mode is recomputed when messages are requested
+  if(it == cache.end() || (it->second.first && !quiet)){
+    ++method_cache_stats_.misses;
+    return nullptr;
+  }
+  ++method_cache_stats_.hits;
+  return &it->second.second;
+}
+
+void CodeTree::add_to_method_cache(method_cache_t& cache, const TypeRcd& type_rcd,
+                                   bool quiet, const std::vector<MethodRcd>& methods) const{
+  int i = index_of(type_rcd);
+  if(i >= 0) cache[i] = std::make_pair(quiet, methods);
+}
+
+std::vector<MethodRcd>
+CodeTree::deduplicated_methods(const TypeRcd& type_rcd, bool quiet) const{
+  auto cached = find_in_method_cache(deduplicated_methods_cache_, type_rcd, quiet);
+  if(cached) return *cached;
+  auto methods = deduplicate_methods(type_rcd.methods, quiet);
+  add_to_method_cache(deduplicated_methods_cache_, type_rcd, quiet, methods);
+  return methods;
+}
+
 std::vector<MethodRcd>
 CodeTree::get_methods_to_wrap(const TypeRcd& type_rcd, bool quiet) const{
+  auto cached = find_in_method_cache(methods_to_wrap_cache_, type_rcd, quiet);
+  if(cached) return *cached;
+  auto methods = compute_methods_to_wrap(type_rcd, quiet);
+  add_to_method_cache(methods_to_wrap_cache_, type_rcd, quiet, methods);
+  return methods;
+}
+
+std::vector<MethodRcd>
+CodeTree::compute_methods_to_wrap(const TypeRcd& type_rcd, bool quiet) const{
 
   //method signature with the child class as prefix
   auto methodsig = [&](const MethodRcd& methodrcd){
-    FunctionWrapper wrapper(cxx_to_julia_, methodrcd, &type_rcd, type_map_, cxxwrap_version_);
     std::string pref = clang_CXXMethod_isStatic(methodrcd.cursor) ? "static " : "";
-    return pref + wrapper.signature(/*cv=*/false, /*map=*/true);
+    return pref + signature(methodrcd.cursor, &type_rcd, false, false, /*map=*/true);
   };
 
   std::vector<MethodRcd> towrap;
   std::set<std::string> sigs;
-  const std::vector<MethodRcd>& own_methods = deduplicate_methods(type_rcd.methods, quiet);
+  const std::vector<MethodRcd>& own_methods = deduplicated_methods(type_rcd, quiet);
 
   for(const auto& m: own_methods){
     towrap.push_back(m);
@@ -3562,12 +5343,11 @@ CodeTree::get_methods_to_wrap(const TypeRcd& type_rcd, bool quiet) const{
   if(!multipleInheritance_) return towrap;
 
   auto [mapped_base, extra_direct_parents ] = getParentClassesForWrapper(type_rcd.cursor);
-  auto it_base_rcd = std::find_if(types_.begin(), types_.end(),
-                                  [&](auto a){ return clang_equalCursors(a.cursor, mapped_base);});
+  int i_base_rcd = find_type_index(mapped_base);
 
   std::vector<MethodRcd> base_methods;
-  if(it_base_rcd != types_.end() && !clang_Cursor_isNull(it_base_rcd->cursor)){
-    base_methods = get_methods_to_wrap(*it_base_rcd, /*quiet=*/true);
+  if(i_base_rcd >= 0 && !clang_Cursor_isNull(types_[i_base_rcd].cursor)){
+    base_methods = get_methods_to_wrap(types_[i_base_rcd], /*quiet=*/true);
   }
 
   //check if the method x has the same function name of one of the methods
@@ -3642,17 +5422,14 @@ CodeTree::get_methods_to_wrap(const TypeRcd& type_rcd, bool quiet) const{
     auto itTypeRcd = types_.end();
 
     if(!clang_Cursor_isNull(c)){
-      const auto& t = clang_getCursorType(c);
-      itTypeRcd = std::find_if(types_.begin(), types_.end(),
-                               [&t](const auto& x){
-                                 return same_type(t, clang_getCursorType(x.cursor));
-                               });
+      int i = find_type_index(clang_getCursorType(c));
+      if(i >= 0) itTypeRcd = types_.begin() + i;
     }
 
     funcnames.clear();
     //if the class was found, pass through its methods
     if(itTypeRcd != types_.end()){
-      for(const auto& m: deduplicate_methods(itTypeRcd->methods, /*quiet=*/true)){
+      for(const auto& m: deduplicated_methods(*itTypeRcd, /*quiet=*/true)){
         auto kind = clang_getCursorKind(m.cursor);
         auto is_static = clang_CXXMethod_isStatic(m.cursor);
         if(kind != CXCursor_Constructor
@@ -3711,11 +5488,7 @@ CodeTree::get_methods_to_wrap(const TypeRcd& type_rcd, bool quiet) const{
       //check veto both with the name of this class and of the ancestor
       //that declared the method
       for(const auto& t: {type_rcd, m.second[0].first}){
-        FunctionWrapper wrapper(cxx_to_julia_, m.second[0].second,
-                                &t, type_map_,
-                                cxxwrap_version_);
-        vetoed |= (std::find(veto_list_.begin(), veto_list_.end(),
-                             wrapper.signature()) != veto_list_.end());
+        vetoed |= veto_list_.has_line(signature(m.second[0].second.cursor, &t));
       }
       if(!vetoed) towrap.push_back(m.second[0].second);
     } else{
@@ -12,6 +12,8 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <functional>
 #include <regex>
@@ -31,6 +33,11 @@
 
 #include "TypeMapper.h"
 #include "Graph.h"
+#include "CursorIndex.h"
+#include "BuildTester.h"
+#include "VetoList.h"
+#include "SignatureCache.h"
+#include "BufferedFile.h"
 
 //to be used by set<CXCursor>
 static bool operator<(const CXCursor& c1, const CXCursor& c2){
@@ -41,12 +48,22 @@ static bool operator<(const CXCursor& c1, const CXCursor& c2){
 
 namespace fs = std::filesystem;
 
+class FunctionWrapper;
 
 namespace codetree{
 
   enum class propagation_mode_t { types, methods };
   enum class export_mode_t { none, member_functions, all_functions, all };
 
+  //Split of the lazily registered methods in separate shared libraries
+  enum class lib_split_t { none, namespaces, files };
+
+  //Generation of the class method wrappers. lambdas: one lambda per
+  //receiver kind (reference and pointer) and per number of arguments.
+  //ptr_adapter: reference receivers only, the pointer receivers are
+  //forwarded by a Julia method.
+  enum class method_wrapper_strategy_t { lambdas, ptr_adapter };
+
   class CodeTree{
   public:
     CodeTree(): module_name_("Module"),
@@ -60,7 +77,7 @@ namespace codetree{
                 multipleInheritance_(true),
                 unit_(nullptr), index_(nullptr), n_classes_per_file_(-1),
                 build_cmd_("echo Build command not defined."),
-                test_build_(false), ibuild_(0), build_nskips_(0),
+                test_build_(false), build_nskips_(0),
                 build_nmax_(-1), build_every_(1),
                 visiting_a_templated_class_(false),
                 accessor_generation_enabled_(false),
@@ -90,20 +107,25 @@ namespace codetree{
     std::vector<std::string> files_to_wrap_;
     std::vector<std::string> files_to_wrap_fullpaths_;
 
-    //the two following vector must be kept in sync
+    //Cache of the fromMainFiles() result per source file
+    mutable std::unordered_map<CXFile, bool> main_file_cache_;
+
+    //the two following vector and the set must be kept in sync
     //use reset_wrappped_methods() and add_wrapped_methods()
     //to update them.
     std::vector<std::string> wrapped_methods_;
     std::vector<std::string> wrapped_methods_after_map_;
+    std::unordered_set<std::string> wrapped_methods_after_map_set_;
 
     int n_classes_per_file_;
+
+    unsigned n_balanced_files_ = 0;
     std::string out_cxx_dir_;
     std::string out_jl_dir_;
 
 
     std::string build_cmd_;
     bool test_build_;
-    int ibuild_;
     int build_nskips_;
     int build_nmax_;
     int build_every_;
@@ -128,21 +150,21 @@ namespace codetree{
 
     static std::string resolve_clang_resource_dir_path(std::string relpath);
 
-    bool has_cursor(const std::vector<CXCursor> vec, const CXCursor& cursor){
+    bool has_cursor(const std::vector<CXCursor>& vec, const CXCursor& cursor){
       for(const auto& c: vec){
-        if(clang_equalCursors(c, cursor)) return true;
+        if(CursorIndex::same_declaration(c, cursor)) return true;
       }
       return false;
     }
 
-    bool has_cursor(const std::vector<TypeRcd> vec, const CXCursor& cursor){
+    bool has_cursor(const std::vector<TypeRcd>& vec, const CXCursor& cursor){
       for(const auto& e: vec){
-        if(clang_equalCursors(e.cursor, cursor)) return true;
+        if(CursorIndex::same_declaration(e.cursor, cursor)) return true;
       }
       return false;
     }
 
-    bool has_type_name(const std::vector<TypeRcd> vec, const std::string& type_name){
+    bool has_type_name(const std::vector<TypeRcd>& vec, const std::string& type_name){
       for(const auto& e: vec){
         if(e.type_name == type_name) return true;
       }
@@ -173,6 +195,10 @@ namespace codetree{
       update_mode_ = true;
     }
 
+    //Directory where to cache the AST of the parsed header files.
+    //Empty string disables the caching
+    void set_pch_cache_dir(const std::string& val){ pch_cache_dir_ = val; }
+
     bool fromMainFiles(const CXCursor& cursor) const;
 
     std::string wrapper_classsname(const std::string& classname) const;
@@ -209,6 +235,13 @@ namespace codetree{
 
     bool parse();
 
+    //List of the files included by the parsed code. To be
+    //called after parse().
+    std::vector<std::string> included_files() const;
+
+    //List of the C++ files produced by generate_cxx().
+    std::vector<std::string> generated_files() const;
+
     void parse_vetoes(const fs::path& fname);
 
     std::ostream& generate_jl(std::ostream& o,
@@ -273,6 +306,20 @@ namespace codetree{
 
     void build_every(int val){ build_every_ = val;}
 
+    //Compiles the code recorded in the test_build mode, generate_cxx()
+    //must be called before. Returns false if any of the code fails
+    //to compile. Does nothing if the test_build mode is disabled.
+    bool run_test_build();
+
+    //Enables the automatic veto list generation: the generated wrapper
+    //files are compiled and the signatures of the wrappers that fail to compile
+    //are written in the file fname, in the veto file format.
+    void set_auto_veto_build(const std::string& fname){ auto_veto_build_file_ = fname; }
+
+    //Runs the automatic veto list generation. Does nothing if not enabled.
+    //generate_cxx() must be called before. Returns false in case of error.
+    bool run_auto_veto_build();
+
     void add_export_veto_word(const std::string& s) { export_blacklist_.insert(s); }
 
     //Sets version of CxxWrap the code should be generated for.
@@ -282,6 +329,59 @@ namespace codetree{
 
     void set_n_classes_per_file(int n_classes_per_file) { n_classes_per_file_ = n_classes_per_file; }
 
+    //Sets the number of files to distribute the class wrappers in, balancing
+    //their estimated compilation cost. 0 to use n_classes_per_file instead.
+    void set_n_balanced_files(int n) { n_balanced_files_ = n > 0 ? n : 0; }
+
+    //Enables the registration on first use of the methods of the
+    //non-templated classes and of the global functions
+    void set_lazy_method_registration(bool v) { lazy_method_registration_ = v; }
+
+    void set_method_wrapper_strategy(method_wrapper_strategy_t v){ method_wrapper_strategy_ = v; }
+
+    //Sets the functions to generate a batched variant for, as signatures
+    //or regular expressions with the syntax of the veto file
+    void set_broadcast_methods(const std::vector<std::string>& signatures){
+      for(const auto& s: signatures) broadcast_list_.add(s);
+    }
+
+    //Enables the generation of overloads exchanging the std::vector of
+    //arithmetic types as Julia arrays
+    void set_vector_overloads(bool v) { vector_overloads_ = v; }
+
+    //Sets the global functions to call from Julia with ccall through an
+    //extern "C" thunk instead of the CxxWrap dispatch, as signatures or
+    //regular expressions with the syntax of the veto file
+    void set_ccall_functions(const std::vector<std::string>& signatures){
+      for(const auto& s: signatures) ccall_list_.add(s);
+    }
+
+    //Sets the functions to call with the Julia thread in GC-safe state,
+    //as signatures or regular expressions with the syntax of the veto file
+    void set_gc_safe_functions(const std::vector<std::string>& signatures){
+      for(const auto& s: signatures) gc_safe_list_.add(s);
+    }
+
+    //Sets the records to map to Julia isbits structs, as type names or
+    //regular expressions with the syntax of the veto file
+    void set_isbits_types(const std::vector<std::string>& names){
+      for(const auto& s: names) isbits_list_.add(s);
+    }
+
+    //Puts the lazily registered methods in separate shared libraries, one
+    //per top-level namespace or one per wrapper file. Implies lazy method
+    //registration.
+    void set_lib_split(lib_split_t mode) {
+      lib_split_ = mode;
+      if(mode != lib_split_t::none) lazy_method_registration_ = true;
+    }
+
+    //Sets the number of translation units the input headers are split in
+    void set_n_parse_units(int n) { n_parse_units_ = n > 0 ? n : 1; }
+
+    //Sets the number of processes to use to generate the wrapper files
+    void set_njobs(unsigned n) { njobs_ = n > 0 ? n : 1; }
+
     void set_out_cxx_dir(const std::string& val) { out_cxx_dir_ = val; }
 
     void set_out_jl_dir(const std::string& val) { out_jl_dir_ = val; }
@@ -290,6 +390,10 @@ namespace codetree{
 
     void set_force_mode(bool forced){ out_open_mode_ = forced ? std::ios_base::out : std::ios_base::app; }
 
+    //Tells if path is an existing non-empty file that must not be
+    //overwritten, i.e. the force mode is disabled
+    bool is_in_the_way(const std::string& path) const;
+
     void set_ignore_parsing_errors(bool val){ ignore_parsing_errors_ = val; }
 
     void set_julia_names(const std::vector<std::string>& name_map);
@@ -309,6 +413,24 @@ namespace codetree{
     // Returns the index of the added type in the vector types_
     int add_type(const CXCursor& cursor, bool check = true);
 
+    // Updates the type indices for the last element of types_
+    void index_last_type();
+
+    // Index in types_ of the type with the given cursor, -1 if not found
+    int find_type_index(const CXCursor& cursor) const{
+      return type_cursor_index_.find(cursor);
+    }
+
+    // Index in types_ of the first type with the given name, -1 if not found
+    int find_type_index(const std::string& type_name) const{
+      auto it = type_name_index_.find(type_name);
+      return it == type_name_index_.end() ? -1 : it->second.front();
+    }
+
+    // Index in types_ of the first type matching type according
+    // to same_type(), -1 if not found
+    int find_type_index(const CXType& type) const;
+
     // Checks if type is a std::vector or a std::valarray
     // and if it is the case, marks the element type as requiring
     // std::vector and std:valarray support.
@@ -325,23 +447,73 @@ namespace codetree{
     //Look for a file in the include dirs and returns the path
     std::string resolve_include_path(const std::string& fname);
 
-    //Runs the wrapper build command
-    void test_build(std::ostream& o);
+    //Records a block of generated code for the test_build mode. o is the
+    //stream the code is written to, which tells the file it goes to.
+    void add_test_build_block(const std::string& signature, const std::string& type,
+                              const std::string& code, const std::ostream& o);
 
     void set_type_rcd_ctor_info(TypeRcd& rcd);
 
-    CXToken* next_token(CXSourceLocation loc) const;
+    CXToken* next_token(CXTranslationUnit unit, CXSourceLocation loc) const;
     CXSourceRange function_decl_range(const CXCursor& cursor) const;
 
     bool add_type_specialization(TypeRcd* pTypeRcd, const CXType& type);
 
 
-    //Built list of methods to wrap for a class including for
-    //the emulated multi-inheritance
+    //List of methods to wrap for a type, including the methods inherited
+    //from the extra parents. Results are cached, see methods_to_wrap_cache_.
     std::vector<MethodRcd> get_methods_to_wrap(const TypeRcd& type_rcd, bool quiet=false) const;
 
+    std::vector<MethodRcd> compute_methods_to_wrap(const TypeRcd& type_rcd, bool quiet) const;
+
+    //Cached version of deduplicate_methods(type_rcd.methods, quiet)
+    std::vector<MethodRcd> deduplicated_methods(const TypeRcd& type_rcd, bool quiet) const;
+
+    //Index of a record in types_, -1 if it is not an element of types_
+    int index_of(const TypeRcd& type_rcd) const;
+
+    //Method list caches, indexed by types_ index. The flag tells if the
+    //list was computed in quiet mode, i.e. with the messages suppressed.
+    typedef std::unordered_map<unsigned, std::pair<bool, std::vector<MethodRcd>>> method_cache_t;
+
+    const std::vector<MethodRcd>* find_in_method_cache(const method_cache_t& cache,
+                                                       const TypeRcd& type_rcd,
+                                                       bool quiet) const;
+
+    void add_to_method_cache(method_cache_t& cache, const TypeRcd& type_rcd,
+                             bool quiet, const std::vector<MethodRcd>& methods) const;
+
     bool check_resource_dir(bool verbose) const;
 
+    //Key identifying the cached AST for the current header file and
+    //clang options
+    std::string ast_cache_key(const std::vector<const char*>& opts) const;
+
+    //Loads the AST cached under the path base (without extension)
+    //if still valid. Returns nullptr otherwise.
+    CXTranslationUnit load_cached_ast(const std::string& base) const;
+
+    //Saves the parsed AST under the path base (without extension)
+    void save_ast_to_cache(const std::string& base) const;
+
+    //Parses the input headers split in n_parse_units_ translation
+    //units, in parallel, and visits the units in turn. mfopt is the
+    //dependency file option found in opts, empty if none.
+    bool parse_in_several_units(const std::vector<const char*>& opts,
+                                const std::string& mfopt);
+
+    //Visits the AST of a translation unit
+    void visit_unit(CXTranslationUnit unit);
+
+    //In multi-unit parsing mode, returns false for a namespace-level
+    //declaration already visited in a previous translation unit.
+    bool visit_once_across_units(const CXCursor& cursor);
+
+    //Merges the dependency files produced by the parsing of the
+    //different translation units into the cmake_ file.
+    void merge_dependency_files(const std::vector<std::string>& fnames,
+                                const std::vector<std::string>& unit_headers) const;
+
     //Finds the definition of a type or the underlying type in case
     //of a pointer or reference. For a templated type,
     //it retrieves also the types of the template parameters.
@@ -429,6 +601,14 @@ namespace codetree{
 
     std::vector<std::string> get_enum_constants(CXCursor cursor) const;
 
+    //Sets the code generation options of the wrapper of a function
+    //or method, signature being its signature() as computed by
+    //CodeTree::signature(). Returns true if the function is to be called
+    //with ccall.
+    bool configure_method_wrapper(FunctionWrapper& wrapper,
+                                  const std::string& signature,
+                                  bool quiet) const;
+
     std::ostream& method_cxx_decl(std::ostream& o, const TypeRcd& typeRcd,
                                   const MethodRcd& method,
                                   std::string varname = "",
@@ -477,14 +657,102 @@ namespace codetree{
     //before calling this function
     void update_wrapper_filenames();
 
+    //Selects the records of the isbits_types list that can be mapped to
+    //Julia isbits structs. The selected records are not wrapped as classes.
+    void select_isbits_types();
+
+    //Checks that a record can be mapped to a Julia isbits struct and, if
+    //it can, appends it to isbits_types_. checked holds the result of the
+    //records already checked. Returns the reason of the rejection, an empty
+    //string if the record is accepted.
+    std::string add_isbits_type(const CXCursor& cursor,
+                                std::map<std::string, std::string>& checked);
+
+    //Julia type of an isbits struct field. Returns an empty string and
+    //sets why if the type is not supported.
+    std::string isbits_field_jl_type(CXType type,
+                                     std::map<std::string, std::string>& checked,
+                                     std::string& why);
+
+    //Estimate of the cost of compiling the wrapper of a type, in units
+    //of generated wrapper functions.
+    unsigned estimate_compile_cost(const TypeRcd& c) const;
+
+    //Partitions a sequence of elements with given costs into at most
+    //nfiles contiguous chunks of similar total costs. Returns the chunk
+    //index of each element.
+    std::vector<unsigned> balanced_file_partition(const std::vector<unsigned>& costs,
+                                                  unsigned nfiles) const;
+
     std::ostream& generate_version_check_cxx(std::ostream& o) const;
 
+    //Library (lib_split mode) of the lazily registered methods of type t
+    //written in the wrapper file fname
+    std::string lib_group(const TypeRcd& t, const std::string& fname) const;
+
+    //Name of the file holding the code of the library group for the
+    //wrapper file fname
+    std::string lib_group_filename(const std::string& fname,
+                                   const std::string& group) const;
+
+    //Writes the files of the library groups accumulated while generating
+    //the wrapper file fname
+    void write_lib_group_files(const std::string& fname);
+
+    //Writes in the --cmake output the source files of the libraries of
+    //the lib_split mode and a function defining their targets
+    std::ostream& generate_lib_groups_cmake(std::ostream& o) const;
+
+    //Julia methods forwarding the calls on pointers of the ptr_adapter strategy
+    std::ostream& generate_ptr_adapters_jl(std::ostream& o) const;
+
+    //Julia methods routing the broadcast calls to the batched variants of
+    //the functions listed in broadcast_methods
+    std::ostream& generate_broadcast_jl(std::ostream& o) const;
+
+    //Julia methods calling the extern "C" thunks of the ccall_functions
+    std::ostream& generate_ccall_jl(std::ostream& o,
+                                    const std::string& shared_lib_basename) const;
+
+    //Writes the extern "C" thunks accumulated while generating a wrapper file
+    void write_ccall_thunks(std::ostream& o);
+
+    //Layout checks of the records mapped to Julia isbits structs
+    std::ostream& generate_isbits_cxx(std::ostream& o) const;
+
+    //Julia definitions of the isbits structs, with their layout checks
+    std::ostream& generate_isbits_jl(std::ostream& o) const;
+
+    //Julia code loading the lazily registered methods on first use
+    std::ostream& generate_lazy_registration_jl(std::ostream& o,
+                                                const std::string& shared_lib_basename) const;
+
     std::ostream& generate_type_wrapper_header(std::ostream& o) const;
 
-    //Try to open file path for writing. Exit application if
-    //either an existing file is in the way and the force mode is disabled
-    //or the file opening failed.
-    std::ofstream checked_open(const std::string& path) const;
+    //Writes the wrapper file fname for the types of indices itypes
+    void generate_type_file(const std::string& fname,
+                            const std::vector<unsigned>& itypes);
+
+    //Same as calling generate_type_file() for each element of file_groups,
+    //the work being distributed among njobs_ processes.
+    void generate_type_files_in_parallel(const std::vector<std::pair<std::string,
+                                         std::vector<unsigned>>>& file_groups);
+
+    //Serializes the bookkeeping filled during the code generation in a child
+    //process and merges it back in the parent. Elements of the method lists
+    //and counter values preceding the fork, given by snapshot, are
+    //excluded from the serialization.
+    struct generation_snapshot_t;
+    void save_generation_state(std::ostream& o,
+                               const generation_snapshot_t& snapshot) const;
+    void merge_generation_state(std::istream& i);
+
+    //Opens file path for writing. The contents is buffered and written
+    //when the returned object is closed, only if it changed when
+    //only_if_changed is true, the first nskiplines lines being ignored in
+    //the comparison. Exits the application if an existing file is in the way.
+    BufferedFile checked_open(const std::string& path, bool only_if_changed = true,
+                              int nskiplines = 0) const;
 
     std::ostream&
     gen_apply_stl(std::ostream& o, int indent_depth,
@@ -498,6 +766,7 @@ namespace codetree{
                                int* nparams = nullptr) const;
 
     void reset_type_map(){
+      signature_cache_.clear();
       type_map_ = TypeMapper();
       type_map_.add("const std::string_view &", "const char *", "std::string");
       type_map_.add("std::string_view", "const char *", "std::string");
@@ -521,6 +790,13 @@ namespace codetree{
 
     std::vector<std::pair<std::string, std::string>> overlap_skipped_methods_;
 
+    //Signature of a function as returned by FunctionWrapper::signature()
+    //when the function is wrapped for the class pTypeRcd (nullptr for
+    //a global function). The result is cached.
+    std::string signature(const CXCursor& cursor, const TypeRcd* pTypeRcd,
+                          bool withconst = false, bool withstatic = false,
+                          bool aftermap = false) const;
+
     std::vector<MethodRcd>
     deduplicate_methods(const std::vector<MethodRcd>& methods, bool quiet=false) const;
     
@@ -532,6 +808,9 @@ namespace codetree{
                                   const T& list,
                                   const std::string& preample = "");
 
+    //Comma-separated names of the types of a dependency cycle
+    std::string dependency_cycle_str(const std::vector<unsigned>& cycle) const;
+
     static std::string fname2macro(std::string& fname);
     
     std::string clang_resource_dir_;
@@ -546,6 +825,21 @@ namespace codetree{
 
     std::string header_file_path_;
 
+    std::string pch_cache_dir_;
+
+    unsigned njobs_ = 1;
+
+    //Test build engine, used in test_build and auto-veto-build modes
+    std::unique_ptr<BuildTester> build_tester_;
+
+    std::string auto_veto_build_file_;
+
+    //Writes the prefix header of the build tester
+    bool prepare_build_tester();
+
+    //Name of the file the type wrapper code is being written in
+    std::string current_cxx_file_;
+
     std::map<std::string, std::string> cxx_to_julia_;
 
     std::map<std::string, std::string> type_straight_mapping_;
@@ -558,7 +852,7 @@ namespace codetree{
 
     bool mainFileOnly_;
 
-    std::vector<std::string> veto_list_;
+    VetoList veto_list_;
 
     bool override_base_;
 
@@ -575,6 +869,19 @@ namespace codetree{
     CXTranslationUnit unit_;
     CXIndex index_;
 
+    //Translation units and indices beyond the first one when the input
+    //headers are parsed in several units
+    unsigned n_parse_units_ = 1;
+    std::vector<CXTranslationUnit> extra_units_;
+    std::vector<CXIndex> extra_indices_;
+
+    //USRs of the namespace-level declarations visited in the previous
+    //translation units and in the current one. Used to visit only once
+    //the declarations from headers shared by several units.
+    bool multi_unit_visit_ = false;
+    std::unordered_set<std::string> usrs_of_previous_units_;
+    std::unordered_set<std::string> usrs_of_current_unit_;
+
     //Current top-level visited cursor
     CXCursor visited_cursor_;
 
@@ -605,10 +912,87 @@ namespace codetree{
 
     bool import_setindex_;
 
+    //Lazy method registration mode. While a wrapper class is generated,
+    //lazy_o_ receives the code of its methods whose registration is
+    //deferred, and the Julia names of these methods are recorded in
+    //lazy_method_groups_[lazy_group_]. Constructors and Base method
+    //extensions are always registered at module load.
+    bool lazy_method_registration_ = false;
+    std::ostream* lazy_o_ = nullptr;
+    //file that receives the code of lazy_o_ when it goes to a shared library
+    //of the lib_split mode, empty if the code goes to current_cxx_file_
+    std::string lazy_o_file_;
+    std::string lazy_group_;
+    std::map<std::string, std::set<std::string>> lazy_method_groups_;
+
+    //Library split mode. The code of each library, group of lazily
+    //registered methods, is accumulated in lib_group_code_ while a wrapper
+    //file is generated, and written by write_lib_group_files().
+    //lib_group_sources_ lists the files of each library.
+    lib_split_t lib_split_ = lib_split_t::none;
+    std::map<std::string, std::stringstream> lib_group_code_;
+    std::map<std::string, std::set<std::string>> lib_group_sources_;
+    std::map<std::string, std::string> lib_group_of_wrapper_;
+
+    method_wrapper_strategy_t method_wrapper_strategy_ = method_wrapper_strategy_t::lambdas;
+
+    //Julia functions whose pointer receivers are forwarded on the Julia
+    //side (ptr_adapter strategy), with the Julia names of the classes
+    //they are defined for
+    std::map<std::string, std::set<std::string>> ptr_adapters_;
+
+    //Functions to generate a batched variant for
+    VetoList broadcast_list_;
+
+    //Base.broadcasted methods calling the batched variants
+    std::set<std::string> broadcast_jl_;
+
+    bool vector_overloads_ = false;
+
+    //Functions called with ccall, code of their extern "C" thunks for the
+    //wrapper file being generated, and Julia methods calling them: method
+    //signature with Real and Integer arguments -> signature with the exact
+    //argument types -> @ccall expression
+    VetoList ccall_list_;
+    std::stringstream ccall_thunks_;
+    std::map<std::string, std::map<std::string, std::string>> ccall_jl_;
+
+    //Functions called with the Julia thread in GC-safe state
+    VetoList gc_safe_list_;
+
+    //Records mapped to Julia isbits structs (isbits_types parameter), with
+    //their layout as computed by clang. A record is placed after the
+    //records it contains.
+    struct isbits_field_t{
+      std::string name;
+      std::string jl_type;
+      long long offset;
+    };
+    struct isbits_type_t{
+      std::string type_name;
+      std::string jl_name;
+      long long size;
+      long long align;
+      std::vector<isbits_field_t> fields;
+    };
+    VetoList isbits_list_;
+    std::vector<isbits_type_t> isbits_types_;
+
     Graph type_dependencies_;
 
     std::vector<std::pair<std::string, std::string>> class_order_constraints_;
 
+    //Indices of types_ elements by cursor and by type name,
+    //maintained by add_type() and index_last_type()
+    CursorIndex type_cursor_index_;
+    std::unordered_map<std::string, std::vector<unsigned>> type_name_index_;
+
+    //Index by fully qualified name of the cursor type, built lazily
+    mutable std::unordered_map<std::string, unsigned> type_fqn_index_;
+    mutable unsigned n_types_indexed_by_type_ = 0;
+
+    CursorIndex visited_classes_index_;
+
     std::vector<std::string> towrap_type_filenames_;
     std::set<std::string> towrap_type_filenames_set_;
 
@@ -634,8 +1018,21 @@ namespace codetree{
       unsigned global_var_getters = 0;
       unsigned global_var_setters = 0;
       unsigned global_funcs = 0;
+      unsigned lambdas = 0;
     } nwraps_;
 
+    //Method lists computed once per type, filled by preprocess()
+    mutable method_cache_t methods_to_wrap_cache_;
+    mutable method_cache_t deduplicated_methods_cache_;
+
+    mutable struct {
+      unsigned hits = 0;
+      unsigned misses = 0;
+    } method_cache_stats_;
+
+    //Signatures computed by signature(), invalidated when type_map_ changes
+    mutable SignatureCache signature_cache_;
+
   };
 }
 
@@ -0,0 +1,43 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#include "CursorIndex.h"
+#include "utils.h"
+
+std::string CursorIndex::key(const CXCursor& cursor){
+  return str(clang_getCursorUSR(cursor));
+}
+
+bool CursorIndex::same_declaration(const CXCursor& a, const CXCursor& b){
+  if(clang_equalCursors(a, b)) return true;
+  if(clang_Cursor_getTranslationUnit(a) == clang_Cursor_getTranslationUnit(b)){
+    return false;
+  }
+  const auto& usr = key(a);
+  return usr.size() > 0 && usr == key(b);
+}
+
+void CursorIndex::add(const CXCursor& cursor, unsigned index){
+  buckets_[key(cursor)].emplace_back(cursor, index);
+}
+
+int CursorIndex::find(const CXCursor& cursor) const{
+  auto it = buckets_.find(key(cursor));
+  if(it == buckets_.end()) return -1;
+  for(const auto& e: it->second){
+    if(same_declaration(e.first, cursor)) return e.second;
+  }
+  return -1;
+}
+
+std::vector<unsigned> CursorIndex::find_all(const CXCursor& cursor) const{
+  std::vector<unsigned> r;
+  auto it = buckets_.find(key(cursor));
+  if(it == buckets_.end()) return r;
+  for(const auto& e: it->second){
+    if(same_declaration(e.first, cursor)) r.push_back(e.second);
+  }
+  return r;
+}
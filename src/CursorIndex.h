@@ -0,0 +1,42 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#ifndef CURSORINDEX_H
+#define CURSORINDEX_H
+
+#include <clang-c/Index.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Hash index from cursors to positions in a container.
+// Cursors are bucketed by their USR and compared with
+// same_declaration() within a bucket, such that lookups give
+// the same result as a linear search using this function.
+class CursorIndex{
+public:
+  //Equivalent to clang_equalCursors for cursors of a same translation unit.
+  //Cursors from two different units, as obtained when the input headers are
+  //parsed in several units, are considered equal if they have the same
+  //non-empty USR.
+  static bool same_declaration(const CXCursor& a, const CXCursor& b);
+
+  void add(const CXCursor& cursor, unsigned index);
+
+  //Returns the first index recorded for the cursor, -1 if none.
+  int find(const CXCursor& cursor) const;
+
+  //Returns all the indices recorded for the cursor, in insertion order.
+  std::vector<unsigned> find_all(const CXCursor& cursor) const;
+
+  void clear(){ buckets_.clear(); }
+
+private:
+  static std::string key(const CXCursor& cursor);
+
+  std::unordered_map<std::string, std::vector<std::pair<CXCursor, unsigned>>> buckets_;
+};
+
+#endif //CURSORINDEX_H not defined
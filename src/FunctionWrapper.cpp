@@ -8,11 +8,42 @@
 #include "libclang-ext.h"
 #include <sstream>
 #include <regex>
+#include <cctype>
 #include <sstream>
 
 #include "TypeMapper.h"
 #include "cxxwrap_version.h"
 
+namespace {
+  //Argument type with the reference to const removed, invalid type
+  //for a reference to non-const
+  CXType batch_value_type(CXType type){
+    if(type.kind == CXType_LValueReference){
+      auto pointee = clang_getPointeeType(type);
+      if(!clang_isConstQualifiedType(pointee)) return CXType{CXType_Invalid, {nullptr, nullptr}};
+      return pointee;
+    }
+    return type;
+  }
+
+  //C++ element type of the jlcxx arrays of the batched function variants
+  std::string batch_cxx_type(CXType type){
+    return remove_cv(str(clang_getTypeSpelling(clang_getCanonicalType(type))));
+  }
+
+  //Element type of a std::vector of arithmetic type, invalid type if type
+  //is not such a vector
+  CXType arithmetic_vector_eltype(CXType type){
+    static const std::regex re("^std::vector[[:space:]]*<");
+    const CXType invalid{CXType_Invalid, {nullptr, nullptr}};
+    type = clang_getCanonicalType(type);
+    if(!std::regex_search(fully_qualified_name(type), re)
+       || clang_Type_getNumTemplateArguments(type) < 1) return invalid;
+    auto eltype = clang_Type_getTemplateArgumentAsType(type, 0);
+    return jl_arithmetic_type(eltype).size() > 0 ? eltype : invalid;
+  }
+}
+
 std::ostream&
 FunctionWrapper::gen_ctor(std::ostream& o){
   int nargsmin =  std::max(1, method.min_args); //no-arg ctor, aka "default ctor" generate elsewhere with direct call to gen_ctor(std::ostream& o, int nindents,
@@ -431,12 +462,12 @@ std::ostream&
 FunctionWrapper::gen_arg_list(std::ostream& o, int nargs, std::string sep, bool argtype_only) const{
   if(nargs > 0){
     if(method.strict_number_type.size() == 0){
-      if(verbose > 1) {
+      if(verbose > 1 && !quiet_) {
         std::cerr << "Warning : needs for strict typed number arguments for "
                   << signature() << " was not checked.\n";
       }
     } else if(method.strict_number_type.size() < nargs){
-      if(verbose > 0){
+      if(verbose > 0 && !quiet_){
         std::cerr << "Warning : needs for strict typed number arguments for "
                   << signature() << " was not checked properly. Inconsistency "
           "in the number of arguments (" << method.strict_number_type.size()
@@ -522,8 +553,15 @@ FunctionWrapper::gen_func_with_lambdas(std::ostream& o){
 
   int ntypes = (is_static_ || classname.size() == 0) ? 1 : 2;
 
+  //Pointer receiver forwarded by the Julia-side adapter
+  if(ntypes == 2 && !ptr_receiver_lambdas_ && !override_base_){
+    ntypes = 1;
+    uses_ptr_receiver_adapter_ = true;
+  }
+
   for(int itype = 0; itype < ntypes; ++itype){
     for(int nargs = nargsmin; nargs <= nargsmax; ++nargs){
+      ++nlambdas_;
       indent(o, nindents) <<  varname_ << ".method(\"" << name_jl_<<  "\", [](";
       std::string sep;
       //If a non-static method class, generate the first argument
@@ -541,6 +579,7 @@ FunctionWrapper::gen_func_with_lambdas(std::ostream& o){
       o << ")";
       if(!cast_return) o << "->"<< (mapped_return_type);
       o << " { ";
+      if(gc_safe_) o << "WrapitGcSafeRegion gc_safe_region; ";
       if(clang_getCursorResultType(method.cursor).kind != CXType_Void){
         o << "return ";
         if(cast_return){
@@ -562,11 +601,374 @@ FunctionWrapper::gen_func_with_lambdas(std::ostream& o){
   return o;
 }
 
-std::ostream& FunctionWrapper::gen_call_args(std::ostream& o, int nargs) const{
+std::string FunctionWrapper::batch_name_jl() const{
+  if(name_jl_.size() > 0 && name_jl_.back() == '!'){
+    return name_jl_.substr(0, name_jl_.size() - 1) + "_batch!";
+  } else{
+    return name_jl_ + "_batch";
+  }
+}
+
+std::string FunctionWrapper::batch_error() const{
+  if(is_ctor_ || getindex_ || setindex_ || override_base_ || name_jl_.size() == 0){
+    return "constructors, operators, and Base extensions are not supported";
+  }
+  if(templated_) return "methods of class templates are not supported";
+  if(is_variadic) return "variadic functions are not supported";
+
+  if(clang_getNumArgTypes(method_type) == 0) return "the function has no argument";
+
+  return arithmetic_signature_error();
+}
+
+std::string FunctionWrapper::arithmetic_signature_error() const{
+  const int nargs = clang_getNumArgTypes(method_type);
+  for(int i = 0; i < nargs; ++i){
+    auto argtype = clang_getArgType(method_type, i);
+    if(type_map_.is_mapped(argtype)
+       || jl_arithmetic_type(batch_value_type(argtype)).size() == 0){
+      std::stringstream buf;
+      buf << "argument " << (i + 1) << " is not of an arithmetic type passed "
+        "by value or const reference";
+      return buf.str();
+    }
+  }
+
+  if(return_type_.kind != CXType_Void
+     && (type_map_.is_mapped(return_type_, /*as_return=*/true)
+         || jl_arithmetic_type(return_type_).size() == 0)){
+    return "the return value is not void or of an arithmetic type returned by value";
+  }
+  return "";
+}
+
+std::ostream&
+FunctionWrapper::gen_batch(std::ostream& o){
+  const int nargs = clang_getNumArgTypes(method_type);
+  const bool member = !is_static_ && classname.size() > 0;
+  const bool returns_value = return_type_.kind != CXType_Void;
+  const auto& name = batch_name_jl();
+
+  indent(o, nindents) << "// batched variant, to be called with arrays of arguments\n";
+  indent(o, nindents) << varname_ << ".method(\"" << name << "\", [](";
+  std::string sep;
+  if(member){
+    o << classname << cv << "& a";
+    sep = ", ";
+  }
+  for(int i = 0; i < nargs; ++i){
+    o << sep << "jlcxx::ArrayRef<"
+      << batch_cxx_type(batch_value_type(clang_getArgType(method_type, i)))
+      << "> arg" << i;
+    sep = ", ";
+  }
+  o << "){\n";
+  indent(o, nindents + 1) << "const std::size_t n = arg0.size();\n";
+  for(int i = 1; i < nargs; ++i){
+    indent(o, nindents + 1) << "if(arg" << i << ".size() != n) throw std::length_error(\""
+                            << name << ": arrays of different lengths\");\n";
+  }
+  const auto& rtype = returns_value ? batch_cxx_type(return_type_) : "";
+  if(returns_value && !gc_safe_){
+    //the result array is allocated once and filled through its data pointer
+    indent(o, nindents + 1) << "jlcxx::Array<" << rtype << "> r(n);\n";
+    indent(o, nindents + 1) << rtype << "* rdata = jlcxx::ArrayRef<" << rtype
+                            << ">(r.wrapped()).data();\n";
+  } else if(returns_value){
+    //the result array, not rooted, could be collected while in the GC-safe
+    //region: the results are stored in a C++ buffer and copied afterwards
+    indent(o, nindents + 1) << "std::vector<" << rtype << "> rdata(n);\n";
+  }
+  for(int i = 0; i < nargs; ++i){
+    indent(o, nindents + 1) << "const auto* data" << i << " = arg" << i << ".data();\n";
+  }
+  int loop_indent = nindents + 1;
+  if(gc_safe_){
+    indent(o, nindents + 1) << "{\n";
+    indent(o, nindents + 2) << "WrapitGcSafeRegion gc_safe_region;\n";
+    loop_indent = nindents + 2;
+  }
+  indent(o, loop_indent) << "for(std::size_t i = 0; i < n; ++i) ";
+  if(returns_value) o << "rdata[i] = ";
+  if(is_static_) o << classname << "::";
+  if(member) o << "a.";
+  o << name_cxx << "(";
+  sep = "";
+  for(int i = 0; i < nargs; ++i){
+    o << sep << "data" << i << "[i]";
+    sep = ", ";
+  }
+  o << ");\n";
+  if(gc_safe_) indent(o, nindents + 1) << "}\n";
+  if(returns_value && gc_safe_){
+    indent(o, nindents + 1) << "jlcxx::Array<" << rtype << "> r(n);\n";
+    indent(o, nindents + 1) << "std::copy(rdata.begin(), rdata.end(), jlcxx::ArrayRef<"
+                            << rtype << ">(r.wrapped()).data());\n";
+  }
+  if(returns_value) indent(o, nindents + 1) << "return r;\n";
+  indent(o, nindents) << "}";
+  gen_argname_list(o, nargs, ", ");
+  o << ");\n";
+
+  batch_generated_ = true;
+  generated_jl_functions_.insert(name);
+  return o;
+}
+
+std::string FunctionWrapper::batch_broadcast_jl() const{
+  if(!batch_generated_) return "";
+
+  const int nargs = clang_getNumArgTypes(method_type);
+  const bool member = !is_static_ && classname.size() > 0;
+
+  std::stringstream buf;
+  buf << "Base.broadcasted(::typeof(" << jl_identifier(name_jl_) << ")";
+  std::string call_args;
+  if(member){
+    buf << ", a::" << jl_identifier(jl_type_name(classname));
+    call_args = "a";
+  }
+  for(int i = 0; i < nargs; ++i){
+    buf << ", x" << i << "::Vector{"
+        << jl_arithmetic_type(batch_value_type(clang_getArgType(method_type, i))) << "}";
+    call_args += (call_args.size() > 0 ? ", x" : "x") + std::to_string(i);
+  }
+  buf << ") = " << jl_identifier(batch_name_jl()) << "(" << call_args << ")";
+  return buf.str();
+}
+
+std::string FunctionWrapper::ccall_error() const{
+  if(!is_static_ && classname.size() > 0){
+    return "only global functions and static methods are supported";
+  }
+  if(is_ctor_ || getindex_ || setindex_ || override_base_ || name_jl_.size() == 0){
+    return "operators and Base extensions are not supported";
+  }
+  if(templated_) return "methods of class templates are not supported";
+  if(is_variadic) return "variadic functions are not supported";
+  return arithmetic_signature_error();
+}
+
+std::vector<FunctionWrapper::ccall_method_t>
+FunctionWrapper::gen_ccall(std::ostream& o, const std::string& symbol_prefix,
+                           const std::string& lib_jl){
+  const int nargs = clang_getNumArgTypes(method_type);
+  const bool returns_value = return_type_.kind != CXType_Void;
+  const auto& return_cxx = returns_value ? batch_cxx_type(return_type_) : "void";
+  const auto& return_jl = returns_value ? jl_arithmetic_type(return_type_) : "Cvoid";
+
+  //the mangled name makes the symbol unique among the overloads
+  std::string symbol = symbol_prefix + str(clang_Cursor_getMangling(method.cursor));
+  for(auto& c: symbol) if(!std::isalnum(static_cast<unsigned char>(c))) c = '_';
+
+  std::vector<ccall_method_t> jl_methods;
+  for(int n = std::max(0, method.min_args); n <= nargs; ++n){
+    const auto& sym = n < nargs ? symbol + "_" + std::to_string(n) : symbol;
+
+    o << "\n// " << signature() << "\n"
+      << "extern \"C\" JLCXX_ONLY_EXPORTS " << return_cxx << " " << sym << "(";
+    std::string sep;
+    for(int i = 0; i < n; ++i){
+      o << sep << batch_cxx_type(batch_value_type(clang_getArgType(method_type, i)))
+        << " arg" << i;
+      sep = ", ";
+    }
+    //an exception must not unwind through the Julia frames: it is caught
+    //and raised as a Julia error. jl_error does not return and is called
+    //out of the catch block, with the message copied to a buffer that
+    //needs no destruction.
+    o << ") noexcept{\n";
+    indent(o, 1) << "char wrapit_error[1024];\n";
+    indent(o, 1) << "try{\n";
+    if(gc_safe_) indent(o, 2) << "WrapitGcSafeRegion gc_safe_region;\n";
+    indent(o, 2) << (returns_value ? "return " : "");
+    if(is_static_) o << classname << "::";
+    o << name_cxx << "(";
+    sep = "";
+    for(int i = 0; i < n; ++i){
+      o << sep << "arg" << i;
+      sep = ", ";
+    }
+    o << ");\n";
+    if(!returns_value) indent(o, 2) << "return;\n";
+    indent(o, 1) << "} catch(const std::exception& e){\n";
+    indent(o, 2) << "std::snprintf(wrapit_error, sizeof(wrapit_error), \"%s\", e.what());\n";
+    indent(o, 1) << "} catch(...){\n";
+    indent(o, 2) << "std::snprintf(wrapit_error, sizeof(wrapit_error), \"C++ exception in "
+                 << name_cxx << "\");\n";
+    indent(o, 1) << "}\n";
+    indent(o, 1) << "jl_error(wrapit_error);\n";
+    o << "}\n";
+
+    //the arguments are converted to the C types by @ccall
+    std::stringstream args_jl;
+    std::stringstream exact_args_jl;
+    sep = "";
+    for(int i = 0; i < n; ++i){
+      auto argtype = batch_value_type(clang_getArgType(method_type, i));
+      auto kind = clang_getCanonicalType(argtype).kind;
+      args_jl << sep << "arg" << i << "::"
+              << ((kind == CXType_Float || kind == CXType_Double) ? "Real" : "Integer");
+      exact_args_jl << sep << "arg" << i << "::" << jl_arithmetic_type(argtype);
+      sep = ", ";
+    }
+    const auto& fjl = jl_identifier(name_jl_);
+    jl_methods.push_back(ccall_method_t{fjl + "(" + args_jl.str() + ")",
+                                        fjl + "(" + exact_args_jl.str() + ")",
+                                        "@ccall " + lib_jl + "." + sym + "("
+                                        + exact_args_jl.str() + ")::" + return_jl});
+  }
+
+  generated_jl_functions_.insert(name_jl_);
+  return jl_methods;
+}
+
+FunctionWrapper::vector_arg_t FunctionWrapper::vector_arg(CXType type) const{
+  if(type_map_.is_mapped(type)) return vector_arg_t{};
+  if(type.kind == CXType_LValueReference){
+    auto pointee = clang_getPointeeType(type);
+    auto eltype = arithmetic_vector_eltype(pointee);
+    if(eltype.kind == CXType_Invalid) return vector_arg_t{};
+    return vector_arg_t{batch_cxx_type(eltype), clang_isConstQualifiedType(pointee) != 0};
+  } else{
+    auto eltype = arithmetic_vector_eltype(type);
+    if(eltype.kind == CXType_Invalid) return vector_arg_t{};
+    return vector_arg_t{batch_cxx_type(eltype), true};
+  }
+}
+
+bool FunctionWrapper::vector_overloads_supported() const{
+  return !is_ctor_ && !getindex_ && !setindex_ && !override_base_ && !templated_
+    && !is_variadic && name_jl_.size() > 0;
+}
+
+std::ostream&
+FunctionWrapper::gen_vector_overloads(std::ostream& o){
+  if(!vector_overloads_supported()) return o;
+
+  const int nargs = clang_getNumArgTypes(method_type);
+  const bool member = !is_static_ && classname.size() > 0;
+
+  auto gen_head = [&](const std::string& name_jl,
+                      const std::vector<std::string>& arg_decls){
+    indent(o, nindents) << varname_ << ".method(\"" << name_jl << "\", [](";
+    std::string sep;
+    if(member){
+      o << classname << cv << "& a";
+      sep = ", ";
+    }
+    for(const auto& d: arg_decls){
+      o << sep << d;
+      sep = ", ";
+    }
+    o << ")";
+  };
+
+  //call of the C++ function, in a GC-safe region for the functions of
+  //gc_safe_functions. The conversions from and to the Julia arrays are
+  //done outside of the region.
+  auto gen_call = [&](const std::vector<std::string>& substitutes){
+    if(gc_safe_) o << "[&]() -> decltype(auto) { WrapitGcSafeRegion gc_safe_region; return ";
+    if(is_static_) o << classname << "::";
+    if(member) o << "a.";
+    o << name_cxx << "(";
+    gen_call_args(o, nargs, substitutes);
+    o << ")";
+    if(gc_safe_) o << "; }()";
+  };
+
+  auto gen_tail = [&](){
+    std::string sep = ", ";
+    gen_argname_list(o, nargs, sep);
+    o << ");\n";
+  };
+
+  //Overload taking the input vectors as Julia arrays
+  std::vector<std::string> arg_decls(nargs);
+  std::vector<std::string> substitutes(nargs);
+  std::vector<std::string> vector_copies(nargs);
+  bool with_vector_arg = false;
+  for(int i = 0; i < nargs; ++i){
+    const auto& v = vector_arg(clang_getArgType(method_type, i));
+    if(v.eltype.size() > 0 && v.input){
+      std::stringstream buf;
+      buf << "jlcxx::ArrayRef<" << v.eltype << "> arg" << i;
+      arg_decls[i] = buf.str();
+      buf.str("");
+      buf << "std::vector<" << v.eltype << ">(arg" << i << ".begin(), arg" << i << ".end())";
+      vector_copies[i] = buf.str();
+      substitutes[i] = gc_safe_ ? "vec" + std::to_string(i) : buf.str();
+      with_vector_arg = true;
+    } else{
+      arg_decls[i] = arg_decl(i, false);
+    }
+  }
+
+  if(with_vector_arg){
+    indent(o, nindents) << "// overload taking the std::vector arguments as Julia arrays\n";
+    gen_head(name_jl_, arg_decls);
+    bool cast_return;
+    std::string mapped_return_type
+      = fix_template_type(type_map_.mapped_typename(return_type_,
+                                                    /*as_return=*/true,
+                                                    &cast_return));
+    if(!cast_return) o << "->" << mapped_return_type;
+    o << " { ";
+    //in GC-safe mode, the vectors are copied before entering the region
+    for(int i = 0; gc_safe_ && i < nargs; ++i){
+      if(vector_copies[i].size() > 0) o << "auto vec" << i << " = " << vector_copies[i] << "; ";
+    }
+    if(return_type_.kind != CXType_Void){
+      o << "return ";
+      if(cast_return) o << "(" << mapped_return_type << ")";
+    }
+    gen_call(substitutes);
+    o << "; }";
+    gen_tail();
+    ++nlambdas_;
+  }
+
+  //Variant returning the std::vector as a Julia array
+  const auto& r = vector_arg(return_type_);
+  if(r.eltype.size() > 0){
+    for(int i = 0; i < nargs; ++i) arg_decls[i] = arg_decl(i, false);
+    if(return_type_.kind == CXType_LValueReference && !r.input){
+      indent(o, nindents) << "// view of the returned std::vector, valid as long as the vector\n";
+      indent(o, nindents) << "// is not resized or destroyed\n";
+      gen_head(name_jl_ + "_view", arg_decls);
+      o << " { auto& v = ";
+      gen_call({});
+      o << "; return jlcxx::ArrayRef<" << r.eltype << ">(v.data(), v.size()); }";
+      gen_tail();
+      generated_jl_functions_.insert(name_jl_ + "_view");
+    } else{
+      indent(o, nindents) << "// returned std::vector copied to a Julia array\n";
+      gen_head(name_jl_ + "_array", arg_decls);
+      o << " { const auto& v = ";
+      gen_call({});
+      o << "; jlcxx::Array<" << r.eltype << "> r(v.size()); "
+        "std::copy(v.begin(), v.end(), jlcxx::ArrayRef<" << r.eltype
+        << ">(r.wrapped()).data()); return r; }";
+      gen_tail();
+      generated_jl_functions_.insert(name_jl_ + "_array");
+    }
+    ++nlambdas_;
+  }
+
+  return o;
+}
+
+std::ostream& FunctionWrapper::gen_call_args(std::ostream& o, int nargs,
+                                             const std::vector<std::string>& substitutes) const{
   std::string sep = "";
   std::stringstream cast_op;
   std::regex re_arr("(.*)\\[.*\\]");
   for(decltype(nargs) iarg = 0; iarg < nargs; ++iarg){
+    if(iarg < (int) substitutes.size() && substitutes[iarg].size() > 0){
+      o << sep << substitutes[iarg];
+      sep = ", ";
+      continue;
+    }
     cast_op.str("");
     const auto& argtype = clang_getArgType(method_type, iarg);
     if(type_map_.is_mapped(argtype)
@@ -797,27 +1199,33 @@ FunctionWrapper::FunctionWrapper(const std::map<std::string, std::string>& name_
 }
 
 bool
-FunctionWrapper::validate(){
+FunctionWrapper::validate() const{
   if(name_cxx == "operator[]" && clang_getNumArgTypes(method_type) !=1){
-    std::cerr << "Warning: " << method_type << " is skipped because of its "
-              << "unexpected number of parameters " << clang_getNumArgTypes(method_type)
-              << ". One paramter was expected.\n";
+    if(!quiet_){
+      std::cerr << "Warning: " << method_type << " is skipped because of its "
+                << "unexpected number of parameters " << clang_getNumArgTypes(method_type)
+                << ". One paramter was expected.\n";
+    }
     return false;
   }
 
   if(inaccessible_type){
-    std::cerr << "Warning: no wrapper generated for function '"
-              << signature() << cv
-              << "' because it requires a type that is private or protected.\n";
+    if(!quiet_){
+      std::cerr << "Warning: no wrapper generated for function '"
+                << signature() << cv
+                << "' because it requires a type that is private or protected.\n";
+    }
     return false;
   }
 
   if(is_variadic){
     //The code generated for varidadic functions does not compile.
     //Until, it is fixed, skipped these functions
-    std::cerr << "Warning: no wrapper will be produced for function '"
-              << signature() << cv
-              << "' because of lack of support for variadic functions.\n";
+    if(!quiet_){
+      std::cerr << "Warning: no wrapper will be produced for function '"
+                << signature() << cv
+                << "' because of lack of support for variadic functions.\n";
+    }
     return false;
   }
 
@@ -825,10 +1233,12 @@ FunctionWrapper::validate(){
     //The code generated for a function with an argument passed as a r-value
     //reference does not compile.
     //Until, it is fixed, skipped these functions
-    std::cerr << "Warning: no wrapper will be produced for function '"
-              << signature() << cv
-              << "' because it contains an argument passed by r-value "
-              << "which is not supported yet.\n";
+    if(!quiet_){
+      std::cerr << "Warning: no wrapper will be produced for function '"
+                << signature() << cv
+                << "' because it contains an argument passed by r-value "
+                << "which is not supported yet.\n";
+    }
     return false;
   }
 
@@ -885,11 +1295,12 @@ FunctionWrapper::generate(std::ostream& o,
     return o;
   }
 
+  const auto& sig = signature();
   indent(o, nindents)
     << "DEBUG_MSG(\"Adding wrapper for "
-    << signature()
+    << sig
     << " (\" __HERE__ \")\");""\n";
-  indent(o,nindents) << "// signature to use in the veto list: " << signature() << "\n";
+  indent(o,nindents) << "// signature to use in the veto list: " << sig << "\n";
 
   indent(o, nindents) << "// defined in "     << clang_getCursorLocation(method.cursor) << "\n";
 
@@ -899,9 +1310,55 @@ FunctionWrapper::generate(std::ostream& o,
   //and methods for default parameter values otherwise.
   gen_func_with_lambdas(o);
 
+  if(batch_ && batch_error().empty()) gen_batch(o);
+
+  if(vector_overloads_) gen_vector_overloads(o);
+
   return o;
 }
 
+unsigned FunctionWrapper::estimate_nwrappers() const{
+  //Mirrors generate()
+  if(!validate()) return 0;
+
+  if(setindex_ || getindex_) return (setindex_ ? 1 : 0) + (getindex_ ? 1 : 0);
+
+  //one constructor per number of arguments, the no-argument one being
+  //generated elsewhere, see gen_ctor()
+  if(is_ctor_){
+    if(is_abstract_) return 0;
+    const int nargsmin = std::max(1, method.min_args);
+    const int nargsmax = clang_getNumArgTypes(method_type);
+    return nargsmax >= nargsmin ? nargsmax - nargsmin + 1 : 0;
+  }
+
+  unsigned n = all_lambda_ ? 0 : 1;
+
+  //lambdas of gen_func_with_lambdas()
+  int nargsmax = clang_getNumArgTypes(method_type);
+  if(!all_lambda_) nargsmax -= 1;
+  int ntypes = (is_static_ || classname.size() == 0) ? 1 : 2;
+  if(ntypes == 2 && !ptr_receiver_lambdas_ && !override_base_) ntypes = 1;
+  if(nargsmax >= method.min_args) n += ntypes * (nargsmax - method.min_args + 1);
+
+  if(batch_ && batch_error().empty()) ++n;
+
+  //overloads of gen_vector_overloads()
+  if(vector_overloads_ && vector_overloads_supported()){
+    const int nargs = clang_getNumArgTypes(method_type);
+    for(int i = 0; i < nargs; ++i){
+      const auto& v = vector_arg(clang_getArgType(method_type, i));
+      if(v.eltype.size() > 0 && v.input){
+        ++n;
+        break;
+      }
+    }
+    if(vector_arg(return_type_).eltype.size() > 0) ++n;
+  }
+
+  return n;
+}
+
 bool FunctionWrapper::isAccessible(CXType type) const{
   CXType type1 = {CXType_Invalid, nullptr};
   while((type.kind == CXType_Pointer || type.kind == CXType_LValueReference)
@@ -96,13 +96,92 @@ public:
 
   bool is_ctor() const { return is_ctor_;}
 
+  /// When false, the wrappers of non-static class methods take the instance
+  /// by reference only. The calls on pointers are then forwarded on the
+  /// Julia side. Base method extensions keep both receivers.
+  void set_ptr_receiver_lambdas(bool v) { ptr_receiver_lambdas_ = v; }
+
+  /// Tells if the generated method wrapper requires the Julia-side
+  /// forwarding of pointer receivers
+  bool uses_ptr_receiver_adapter() const { return uses_ptr_receiver_adapter_; }
+
+  /// Number of lambda functions generated by gen_func_with_lambdas()
+  unsigned nlambdas() const { return nlambdas_; }
+
+  /// Number of functions generate() registers with jlcxx::Module::method,
+  /// lambdas included, computed without generating the code. The getindex
+  /// wrapper, which generate() skips when already registered, is counted.
+  unsigned estimate_nwrappers() const;
+
+  /// Disables the warnings on the functions that cannot be wrapped. Used
+  /// when the wrapper is only measured.
+  void set_quiet(bool v) { quiet_ = v; }
+
+  /// Requests the generation of a batched variant of the function, see
+  /// gen_batch(). Ignored if the function does not support it, in which
+  /// case batch_error() gives the reason.
+  void set_batch(bool v) { batch_ = v; }
+
+  /// Julia name of the batched variant of the function
+  std::string batch_name_jl() const;
+
+  /// Tells if the function supports a batched variant: at least one
+  /// argument, arguments and return value of arithmetic types passed by
+  /// value or const reference. Returns an empty string if it does,
+  /// otherwise the reason why it does not.
+  std::string batch_error() const;
+
+  /// Julia method routing a broadcast call of the function over vectors to
+  /// its batched variant. Empty string if no batched variant was generated.
+  std::string batch_broadcast_jl() const;
+
+  /// Enables the generation of the std::vector overloads, see
+  /// gen_vector_overloads().
+  void set_vector_overloads(bool v) { vector_overloads_ = v; }
+
+  /// Requests the call of the C++ function with the calling Julia thread
+  /// in GC-safe state, letting the garbage collector run in other threads.
+  /// The function must not access Julia objects.
+  void set_gc_safe(bool v) {
+    gc_safe_ = v;
+    //the region is opened in the lambda
+    if(v) all_lambda_ = true;
+  }
+
+  /// Tells if the function can be called from Julia with ccall through an
+  /// extern "C" thunk: global function or static method, with arguments and
+  /// return value of arithmetic types passed by value or const reference.
+  /// Returns an empty string if it can, otherwise the reason why it cannot.
+  std::string ccall_error() const;
+
+  /// Julia method calling an extern "C" thunk with @ccall
+  struct ccall_method_t{
+    /// signature with the arguments typed as Real or Integer
+    std::string head;
+    /// signature with the arguments of the exact C types
+    std::string exact_head;
+    /// @ccall expression
+    std::string call;
+  };
+
+  /// Generates the extern "C" thunks calling the function, one per number
+  /// of arguments when some arguments have default values. Their names
+  /// start with symbol_prefix. Returns the Julia methods calling them with
+  /// @ccall from the library lib_jl.
+  std::vector<ccall_method_t> gen_ccall(std::ostream& o,
+                                        const std::string& symbol_prefix,
+                                        const std::string& lib_jl);
+
 protected:
 
   std::ostream& gen_arg_list(std::ostream& o, int nargs, std::string sep, bool argtypes_only = false) const;
 
   std::ostream& gen_argname_list(std::ostream& o, int nargs, std::string sep) const;
 
-  std::ostream& gen_call_args(std::ostream&  o, int nargs) const;
+  // Generates the argument list of the wrapped function call. A non-empty
+  // element i of substitutes replaces the default expression of argument i.
+  std::ostream& gen_call_args(std::ostream&  o, int nargs,
+                              const std::vector<std::string>& substitutes = {}) const;
   
   std::ostream&
   gen_func_with_default_values(std::ostream& o);
@@ -144,8 +223,47 @@ protected:
   std::ostream&
   gen_func_with_lambdas(std::ostream& o);
 
+  // Generates the batched variant of the function. It takes the arguments
+  // as jlcxx::ArrayRef arrays of equal lengths and calls the function for
+  // each of their elements in a C++ loop. The return values are returned
+  // in a jlcxx::Array.
+  std::ostream&
+  gen_batch(std::ostream& o);
+
+  // Tells if the arguments and return value are of arithmetic types passed
+  // by value or const reference. Returns the reason why they are not, or an
+  // empty string.
+  std::string arithmetic_signature_error() const;
+
+  // Generates, for a function with std::vector arguments or return value
+  // of arithmetic element type:
+  // - an overload of the same name taking the std::vector<T> and
+  //   const std::vector<T>& arguments as jlcxx::ArrayRef<T>, which maps to
+  //   Julia Vector{T}. The elements are copied to a std::vector in a single
+  //   C++ operation;
+  // - for a std::vector returned by non-const reference, a function
+  //   <name>_view returning a jlcxx::ArrayRef pointing to the vector data,
+  //   without copy;
+  // - for a std::vector returned by value or const reference, a function
+  //   <name>_array returning a Julia array filled with a single copy. A view
+  //   would let Julia write in the const vector.
+  // Overloads are generated for the full argument list only.
+  std::ostream&
+  gen_vector_overloads(std::ostream& o);
+
+  struct vector_arg_t{
+    //C++ element type, empty if not a std::vector of arithmetic type
+    std::string eltype;
+    //true if passed by value or const reference
+    bool input = false;
+  };
+
+  vector_arg_t vector_arg(CXType type) const;
+
+  bool vector_overloads_supported() const;
+
   bool
-  validate();
+  validate() const;
 
   bool isAccessible(CXType type) const;
 
@@ -198,6 +316,17 @@ private:
 
   bool templated_;
 
+  bool ptr_receiver_lambdas_ = true;
+  bool uses_ptr_receiver_adapter_ = false;
+  unsigned nlambdas_ = 0;
+  bool quiet_ = false;
+
+  bool gc_safe_ = false;
+  bool batch_ = false;
+  bool batch_generated_ = false;
+
+  bool vector_overloads_ = false;
+
   const TypeMapper& type_map_;
 };
 
@@ -1,7 +1,12 @@
 #include "Graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
 void Graph::extend(unsigned n){
-  if(n > edges_.size()){
-    edges_.resize(n);
+  if(n > nnodes_){
+    nnodes_ = n;
     sorted_ = false;
   }
 }
@@ -15,12 +20,14 @@ void Graph::preceeds(unsigned v, unsigned w){
   //invalidate the sorting:
   sorted_ = false;
 
-  unsigned min_nodes = std::max(v, w) + 1;
-  if(min_nodes > edges_.size()){
-    edges_.resize(min_nodes);
-  }
+  nnodes_ = std::max(nnodes_, std::max(v, w) + 1);
 
-  edges_[w].push_back(v);
+  edges_.emplace_back(v, w);
+}
+
+void Graph::setKeys(std::vector<std::string> keys){
+  keys_ = std::move(keys);
+  sorted_ = false;
 }
 
 std::vector<unsigned> Graph::sortedIndices(){
@@ -28,64 +35,171 @@ std::vector<unsigned> Graph::sortedIndices(){
   return sortednodes_;
 }
 
-void Graph::initScan(){
-  sortednodes_.clear();
-  sortednodes_.reserve(edges_.size());
+const std::vector<std::vector<unsigned>>& Graph::cycles(){
+  if(!sorted_) sort();
+  return cycles_;
+}
 
-  visited_.resize(edges_.size());
-  fill(visited_.begin(), visited_.end(), false);
+std::vector<unsigned> Graph::ranks() const{
+  std::vector<unsigned> order(nnodes_);
+  for(unsigned i = 0; i < nnodes_; ++i) order[i] = i;
 
-  cyclicmarks_.resize(edges_.size());
-  fill(cyclicmarks_.begin(), cyclicmarks_.end(), false);
+  if(keys_.size() > 0){
+    static const std::string nokey;
+    auto key = [&](unsigned i) -> const std::string& {
+      return i < keys_.size() ? keys_[i] : nokey;
+    };
+    std::stable_sort(order.begin(), order.end(), [&](unsigned a, unsigned b){
+      return key(a) < key(b);
+    });
+  }
 
-  cyclic_ = false;
+  std::vector<unsigned> rank(nnodes_);
+  for(unsigned r = 0; r < nnodes_; ++r) rank[order[r]] = r;
+  return rank;
 }
 
+/* Iterative version of the Tarjan algorithm, to not overflow the stack
+ * on long dependency chains.
+ */
+unsigned Graph::findComponents(const std::vector<unsigned>& offsets,
+                               const std::vector<unsigned>& targets){
+  const unsigned unvisited = -1;
+  std::vector<unsigned> index(nnodes_, unvisited);
+  std::vector<unsigned> low(nnodes_);
+  std::vector<bool> onstack(nnodes_, false);
+  std::vector<unsigned> stack;
+  //call stack of the depth-first search: (node, next edge to follow)
+  std::vector<std::pair<unsigned, unsigned>> calls;
 
-/*function used to sort the indices*/
-void Graph::localSort(unsigned vertex){
+  component_.assign(nnodes_, 0);
+  unsigned nextindex = 0;
+  unsigned ncomponents = 0;
 
-  visited_[vertex] = true;
+  for(unsigned root = 0; root < nnodes_; ++root){
+    if(index[root] != unvisited) continue;
+    calls.emplace_back(root, offsets[root]);
+    index[root] = low[root] = nextindex++;
+    stack.push_back(root);
+    onstack[root] = true;
 
-  //mark that we are starting the following
-  //recursive loops from this vertex:
-  cyclicmarks_[vertex] = true;
+    while(!calls.empty()){
+      auto& [v, iedge] = calls.back();
+      if(iedge < offsets[v + 1]){
+        unsigned w = targets[iedge++];
+        if(index[w] == unvisited){
+          index[w] = low[w] = nextindex++;
+          stack.push_back(w);
+          onstack[w] = true;
+          calls.emplace_back(w, offsets[w]);
+        } else if(onstack[w]){
+          low[v] = std::min(low[v], index[w]);
+        }
+        continue;
+      }
 
-  /*check for all indices preceeding vertex*/
-  for (const auto& node: edges_[vertex]){
-    //    std::cerr<< node << " (" << cyclicmarks_[node]
-    //             << ", " << cyclicmarks_[node] << ") "
-    //             << " ≺ "
-    //             << vertex << " (" << visited_[vertex]
-    //             << ", " << cyclicmarks_[vertex] << ") "
-    //             << "\n";
-    if (!visited_[node]){
-      localSort(node);
+      //all successors of v visited
+      const unsigned vertex = v;
+      calls.pop_back();
+      if(!calls.empty()){
+        auto parent = calls.back().first;
+        low[parent] = std::min(low[parent], low[vertex]);
+      }
+      if(low[vertex] == index[vertex]){
+        unsigned w;
+        do{
+          w = stack.back();
+          stack.pop_back();
+          onstack[w] = false;
+          component_[w] = ncomponents;
+        } while(w != vertex);
+        ++ncomponents;
+      }
     }
-    cyclic_ |= cyclicmarks_[node];
-    //    std::cerr << "cyclic_: " << cyclic_ << "\n";
   }
-
-  //remove the cycling detection mark:
-  cyclicmarks_[vertex] = false;
-
-  //The node vertex has no not-yet-visited preceeding
-  //node, add it to the sorted list:
-  sortednodes_.push_back(vertex);
+  return ncomponents;
 }
 
+/* Topological sort of the graph of the strongly connected components,
+ * using the Kahn algorithm. A component with no remaining predecessor
+ * is picked according to its smallest node rank.
+ */
 void Graph::sort(){
-  initScan();
+  //adjacency arrays: successors of node i are
+  //targets[offsets[i]..offsets[i+1]-1]
+  std::vector<unsigned> offsets(nnodes_ + 1, 0);
+  for(const auto& e: edges_) ++offsets[e.first + 1];
+  for(unsigned i = 0; i < nnodes_; ++i) offsets[i + 1] += offsets[i];
+  std::vector<unsigned> targets(edges_.size());
+  {
+    std::vector<unsigned> pos(offsets.begin(), offsets.end() - 1);
+    for(const auto& e: edges_) targets[pos[e.first]++] = e.second;
+  }
 
-  for (unsigned i = 0; i < visited_.size(); i++){
-    if (visited_[i] == false){ //<-- can be removed...
-      localSort(i);
+  const auto& rank = ranks();
+  const unsigned ncomponents = findComponents(offsets, targets);
+
+  //component members, sorted by rank
+  std::vector<unsigned> compoffsets(ncomponents + 1, 0);
+  for(unsigned i = 0; i < nnodes_; ++i) ++compoffsets[component_[i] + 1];
+  for(unsigned c = 0; c < ncomponents; ++c) compoffsets[c + 1] += compoffsets[c];
+  std::vector<unsigned> byrank(nnodes_);
+  for(unsigned i = 0; i < nnodes_; ++i) byrank[rank[i]] = i;
+  std::vector<unsigned> members(nnodes_);
+  {
+    std::vector<unsigned> pos(compoffsets.begin(), compoffsets.end() - 1);
+    for(auto i: byrank) members[pos[component_[i]]++] = i;
+  }
+
+  std::vector<unsigned> indegree(ncomponents, 0);
+  std::vector<bool> selfloop(ncomponents, false);
+  for(const auto& e: edges_){
+    auto c1 = component_[e.first];
+    auto c2 = component_[e.second];
+    if(c1 != c2) ++indegree[c2];
+    else if(e.first == e.second) selfloop[c1] = true;
+  }
+
+  cycles_.clear();
+  for(unsigned c = 0; c < ncomponents; ++c){
+    if(compoffsets[c + 1] - compoffsets[c] > 1 || selfloop[c]){
+      cycles_.emplace_back(members.begin() + compoffsets[c],
+                           members.begin() + compoffsets[c + 1]);
+    }
+  }
+  //list cycles in the order of their first node:
+  std::sort(cycles_.begin(), cycles_.end(), [&](const auto& a, const auto& b){
+    return rank[a.front()] < rank[b.front()];
+  });
+  cyclic_ = !cycles_.empty();
+
+  //priority queue of the ranks of the ready components' first nodes
+  std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>> ready;
+  for(unsigned c = 0; c < ncomponents; ++c){
+    if(indegree[c] == 0) ready.push(rank[members[compoffsets[c]]]);
+  }
+
+  sortednodes_.clear();
+  sortednodes_.reserve(nnodes_);
+  while(!ready.empty()){
+    const unsigned c = component_[byrank[ready.top()]];
+    ready.pop();
+    for(unsigned k = compoffsets[c]; k < compoffsets[c + 1]; ++k){
+      const unsigned v = members[k];
+      sortednodes_.push_back(v);
+      for(unsigned iedge = offsets[v]; iedge < offsets[v + 1]; ++iedge){
+        const unsigned c2 = component_[targets[iedge]];
+        if(c2 != c && --indegree[c2] == 0){
+          ready.push(rank[members[compoffsets[c2]]]);
+        }
+      }
     }
   }
   sorted_ = true;
 }
 
 #if 0 //to test
+#include <iostream>
 int main(){
   // Create a graph given in the above diagram
   Graph g;
@@ -109,14 +223,14 @@ int main(){
   g.preceeds(5, 8);
   g.preceeds(5, 9);
 
-  cout << "Ordered indices: ";
+  std::cout << "Ordered indices: ";
   auto sorted_nodes = g.sortedIndices();
 
 
   for(const auto& e: sorted_nodes){
     std::cout << e << " ";
   }
-  cout << "\n";
+  std::cout << "\n";
 
   std::cout << "Is-cyclic flag: " << g.isCyclic() << "\n";
 
@@ -130,6 +244,14 @@ int main(){
   }
   std::cout << "\nNew is-cyclic flag: " << g.isCyclic() << "\n";
 
+  std::cout << "Cycles:";
+  for(const auto& c: g.cycles()){
+    std::cout << " (";
+    for(const auto& e: c) std::cout << " " << e;
+    std::cout << " )";
+  }
+  std::cout << "\n";
+
   return 0;
 }
 #endif
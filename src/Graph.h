@@ -1,12 +1,13 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
-#include <list>
+#include <string>
 #include <vector>
+#include <utility>
 
 class Graph {
 public:
-  Graph(): cyclic_(false), sorted_(false){}
+  Graph(): nnodes_(0), cyclic_(false), sorted_(false){}
 
   /** Detects if the index ordering graph contains a cycle.
    * Returns true if a cycle was found, false otherwise.
@@ -23,32 +24,56 @@ public:
    * the list goes up to the maximum index passed to the preceeds method (included).
    */
   void extend(unsigned maxIndex);
-  
+
+  /** Sets the keys used to order the indices not constrained by the
+   * preceeds() relations: among the indices whose predecessors are
+   * all placed, the one with the smallest key comes first, ties being broken
+   * by the index value. Without keys, the index values are used.
+   */
+  void setKeys(std::vector<std::string> keys);
+
   /** Returns the index in an order respecting the contraints
    * added with calls to the preceeds() function:
    *
    *  x_0 ≺ x_1 ≺ x_2 ≺ …
    *
-   * cycleDetected is set to true if the dependency graph
-   * contains a cycle e.g. 1 ≻ 2 ≻ 3 ≻ 5 …, 3 ≻ 1.
+   * If the graph contains cycles, e.g. 1 ≻ 2 ≻ 3 ≻ 5 …, 3 ≻ 1, the
+   * indices of a cycle are placed together, in the key order, and the
+   * constraints with the indices outside the cycle are respected.
    */
   std::vector<unsigned> sortedIndices();
 
+  /** Returns the cycles of the graph. Each element lists the indices of
+   * a strongly connected component, in the key order: a group of
+   * indices that all (transitively) preceed each other.
+   */
+  const std::vector<std::vector<unsigned>>& cycles();
+
 private:
-  void initScan();
+  void sort();
 
-  void localSort(unsigned vertex);
+  /** Ranks of the indices in the (key, index) order */
+  std::vector<unsigned> ranks() const;
 
-  void sort();
+  /** Fills component_ with the strongly connected component of each node,
+   * numbered in reversed topological order, and returns the number of
+   * components.
+   */
+  unsigned findComponents(const std::vector<unsigned>& offsets,
+                          const std::vector<unsigned>& targets);
 
-  /* Edges of the graph: vector element at index i contains
-   * the list of nodes that preceeds i
+  unsigned nnodes_;
+
+  /* Edges of the graph, as (i, j) pairs with i ≺ j. They are converted to
+   * contiguous adjacency arrays when sorting.
    */
-  std::vector<std::list<unsigned>> edges_;
+  std::vector<std::pair<unsigned, unsigned>> edges_;
+
+  std::vector<std::string> keys_;
 
-  std::vector<bool> visited_;
-  std::vector<bool> cyclicmarks_;
+  std::vector<unsigned> component_;
   std::vector<unsigned> sortednodes_;
+  std::vector<std::vector<unsigned>> cycles_;
   bool cyclic_;
   bool sorted_;
 };
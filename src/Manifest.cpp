@@ -0,0 +1,100 @@
+#include "Manifest.h"
+#include "md5sum.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+extern int verbose;
+
+namespace {
+  std::string file_md5(const std::string& path){
+    std::vector<unsigned char> md5;
+    md5sum(md5, path);
+    return md5hex(md5);
+  }
+}
+
+bool Manifest::write(const std::string& path) const{
+  //an input left out of the manifest would make it valid whatever
+  //the changes of this input: the manifest is then not written.
+  std::stringstream inputs_buf;
+  for(const auto& p: inputs_){
+    if(!std::ifstream(p).good()){
+      std::cerr << "Warning: failed to read " << p << ". The manifest file "
+                << path << " is not written and the next run in update mode "
+                << "will regenerate the code.\n";
+      std::error_code ec;
+      fs::remove(path, ec);
+      return false;
+    }
+    inputs_buf << "input " << file_md5(p) << " " << p << "\n";
+  }
+
+  std::ofstream f(path);
+  if(!f.good()){
+    std::cerr << "Warning: failed to write the manifest file " << path << ".\n";
+    return false;
+  }
+  f << "# Manifest of the code generated by wrapit. Used in update mode\n"
+    "# to skip the generation when none of the inputs changed.\n"
+    << "version " << version_ << "\n"
+    << "config " << config_digest_ << "\n"
+    << inputs_buf.str();
+  for(const auto& p: outputs_){
+    f << "output " << p << "\n";
+  }
+  return f.good();
+}
+
+bool Manifest::up_to_date(const std::string& path) const{
+  std::ifstream f(path);
+  if(!f.good()) return false;
+
+  bool version_ok = false;
+  bool config_ok = false;
+  std::string line;
+  while(std::getline(f, line)){
+    if(line.size() == 0 || line[0] == '#') continue;
+    std::istringstream l(line);
+    std::string key;
+    l >> key;
+    l.get();
+    if(key == "version"){
+      std::string v;
+      std::getline(l, v);
+      version_ok = (v == version_);
+    } else if(key == "config"){
+      std::string v;
+      std::getline(l, v);
+      config_ok = (v == config_digest_);
+    } else if(key == "input"){
+      std::string md5, p;
+      l >> md5;
+      l.get();
+      std::getline(l, p);
+      if(!fs::exists(p) || file_md5(p) != md5){
+        if(verbose > 0) std::cerr << "Info: " << p << " changed since last code generation.\n";
+        return false;
+      }
+    } else if(key == "output"){
+      std::string p;
+      std::getline(l, p);
+      if(!fs::exists(p)){
+        if(verbose > 0) std::cerr << "Info: " << p << " is missing.\n";
+        return false;
+      }
+    } else{
+      return false;
+    }
+  }
+
+  if(verbose > 0 && !(version_ok && config_ok)){
+    std::cerr << "Info: wrapit version or configuration changed since last code generation.\n";
+  }
+
+  return version_ok && config_ok;
+}
@@ -0,0 +1,40 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <string>
+#include <vector>
+
+// Record of the inputs and outputs of a code generation. It is
+// used in update mode to skip the generation when none of the inputs
+// changed since the previous run.
+class Manifest{
+public:
+  // config_digest: checksum of the configuration (configuration
+  // file contents, veto list, command line options).
+  Manifest(const std::string& wrapit_version, const std::string& config_digest):
+    version_(wrapit_version), config_digest_(config_digest){}
+
+  // Adds a file the generated code depends on.
+  void add_input(const std::string& path){ inputs_.push_back(path); }
+
+  // Adds a file produced by the code generation.
+  void add_output(const std::string& path){ outputs_.push_back(path); }
+
+  // Writes the manifest file. The checksums of the input files
+  // are computed at this stage. If an input file cannot be read, the
+  // manifest is not written and a previous one is removed.
+  bool write(const std::string& path) const;
+
+  // Checks if the manifest file path was produced with the same
+  // wrapit version and configuration, if all the input files recorded in
+  // it are unchanged and all the output files are present.
+  bool up_to_date(const std::string& path) const;
+
+private:
+  std::string version_;
+  std::string config_digest_;
+  std::vector<std::string> inputs_;
+  std::vector<std::string> outputs_;
+};
+
+#endif //MANIFEST_H not defined
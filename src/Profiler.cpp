@@ -0,0 +1,339 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#include "Profiler.h"
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <pthread.h>
+
+namespace {
+  std::atomic<unsigned long long> nallocs_{0};
+
+  //allocations are counted only when the profiler is enabled
+  std::atomic<bool> count_allocs{false};
+
+  //set in a forked process until Profiler::start_worker() is called, for
+  //the scopes opened in the process to not be recorded
+  bool in_forked_process = false;
+
+  //JSON string literal
+  std::string quoted(const std::string& s){
+    std::string r = "\"";
+    for(char c: s){
+      switch(c){
+      case '"':  r += "\\\""; break;
+      case '\\': r += "\\\\"; break;
+      case '\n': r += "\\n"; break;
+      case '\t': r += "\\t"; break;
+      default:
+        if(static_cast<unsigned char>(c) < 0x20){
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          r += buf;
+        } else{
+          r += c;
+        }
+      }
+    }
+    return r + "\"";
+  }
+}
+
+//Global allocation functions, replaced to count the allocations
+void* operator new(std::size_t n){
+  if(count_allocs.load(std::memory_order_relaxed)){
+    nallocs_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if(n == 0) n = 1;
+  for(;;){
+    if(void* p = std::malloc(n)) return p;
+    auto handler = std::get_new_handler();
+    if(!handler) throw std::bad_alloc();
+    handler();
+  }
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept{
+  try{
+    return operator new(n);
+  } catch(...){
+    return nullptr;
+  }
+}
+
+void operator delete(void* p) noexcept{ std::free(p); }
+void operator delete(void* p, std::size_t) noexcept{ std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept{ std::free(p); }
+
+Profiler::Counter::Counter(const char* category, const char* name):
+  category_(category), name_(name){
+  auto& profiler = Profiler::instance();
+  std::lock_guard<std::mutex> lock(profiler.mutex_);
+  next_ = profiler.counters_;
+  profiler.counters_ = this;
+}
+
+Profiler::Scope::Scope(const char* category, const std::string& name):
+  active_(Profiler::instance().enabled()), category_(category), counter_(nullptr){
+  if(active_){
+    name_ = name;
+    start();
+  }
+}
+
+Profiler::Scope::Scope(const char* category, const char* name):
+  active_(Profiler::instance().enabled()), category_(category), counter_(nullptr){
+  if(active_){
+    name_ = name;
+    start();
+  }
+}
+
+Profiler::Scope::Scope(Counter& counter):
+  active_(Profiler::instance().enabled()), category_(counter.category_),
+  counter_(&counter){
+  if(active_) start();
+}
+
+void Profiler::Scope::start(){
+  nallocs0_ = nallocs();
+  cpu0_ = cpu_time_us();
+  wall0_ = std::chrono::steady_clock::now();
+}
+
+Profiler::Scope::~Scope(){
+  if(!active_) return;
+  if(counter_) Profiler::instance().record(*counter_, wall0_, cpu0_, nallocs0_);
+  else Profiler::instance().record(category_, name_, wall0_, cpu0_, nallocs0_);
+}
+
+Profiler::Profiler(): enabled_(false), ntop_types_(20),
+                      t0_(std::chrono::steady_clock::now()),
+                      worker_(0), nallocs_at_start_(0), worker_nallocs_(0),
+                      counters_(nullptr){
+}
+
+Profiler& Profiler::instance(){
+  static Profiler profiler;
+  return profiler;
+}
+
+unsigned long long Profiler::nallocs(){
+  return nallocs_.load(std::memory_order_relaxed);
+}
+
+double Profiler::cpu_time_us(){
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1.e6 + ts.tv_nsec * 1.e-3;
+}
+
+void Profiler::enable(const std::string& path, unsigned ntop_types){
+  //the files are written at exit, whatever the exit path
+  if(!enabled_) std::atexit([]{ Profiler::instance().write(); });
+  path_ = path;
+  ntop_types_ = ntop_types;
+  if(!enabled_) pthread_atfork(nullptr, nullptr, []{ in_forked_process = true; });
+  enabled_ = true;
+  count_allocs.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::record(const char* category, const std::string& name,
+                      std::chrono::steady_clock::time_point wall0, double cpu0,
+                      unsigned long long nallocs0){
+  //scopes opened in a forked process not started with start_worker()
+  if(in_forked_process) return;
+
+  const auto wall1 = std::chrono::steady_clock::now();
+  const double cpu_us = cpu_time_us() - cpu0;
+  const unsigned long long n = nallocs() - nallocs0;
+  const double wall_us = std::chrono::duration<double, std::micro>(wall1 - wall0).count();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto& total = totals_[std::make_pair(std::string(category), name)];
+  ++total.count;
+  total.wall_us += wall_us;
+  total.cpu_us += cpu_us;
+  total.nallocs += n;
+
+  const std::string c(category);
+  if(c == "phase" || c == "type"){
+    static std::map<std::thread::id, unsigned> tids;
+    auto tid = tids.emplace(std::this_thread::get_id(), tids.size()).first->second;
+    events_.push_back(event_t{c, name,
+                              std::chrono::duration<double, std::micro>(wall0 - t0_).count(),
+                              wall_us, cpu_us, n, worker_ + 1, tid});
+  }
+}
+
+void Profiler::record(Counter& counter, std::chrono::steady_clock::time_point wall0,
+                      double cpu0, unsigned long long nallocs0){
+  if(in_forked_process) return;
+
+  const auto wall1 = std::chrono::steady_clock::now();
+  const double cpu_us = cpu_time_us() - cpu0;
+  const unsigned long long n = nallocs() - nallocs0;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& total = counter.total_;
+  ++total.count;
+  total.wall_us += std::chrono::duration<double, std::micro>(wall1 - wall0).count();
+  total.cpu_us += cpu_us;
+  total.nallocs += n;
+}
+
+std::map<std::pair<std::string, std::string>, Profiler::total_t>
+Profiler::all_totals() const{
+  auto totals = totals_;
+  for(const Counter* c = counters_; c; c = c->next_){
+    if(c->total_.count == 0) continue;
+    auto& total = totals[std::make_pair(std::string(c->category_), std::string(c->name_))];
+    total.count += c->total_.count;
+    total.wall_us += c->total_.wall_us;
+    total.cpu_us += c->total_.cpu_us;
+    total.nallocs += c->total_.nallocs;
+  }
+  return totals;
+}
+
+bool Profiler::write() const{
+  if(!enabled_) return true;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::ofstream o(path_);
+  o << std::fixed << std::setprecision(6);
+
+  auto write_total = [&](const std::string& name, const total_t& t){
+    o << "{\"name\": " << quoted(name)
+      << ", \"count\": " << t.count
+      << ", \"wall_s\": " << t.wall_us * 1.e-6
+      << ", \"cpu_s\": " << t.cpu_us * 1.e-6
+      << ", \"allocations\": " << t.nallocs << "}";
+  };
+
+  //totals grouped by category
+  std::map<std::string, std::vector<std::pair<std::string, total_t>>> by_category;
+  for(const auto& [key, t]: all_totals()) by_category[key.first].emplace_back(key.second, t);
+
+  o << "{\n  \"total_allocations\": " << nallocs() + worker_nallocs_ << ",\n";
+  const char* sep = "";
+  for(auto& [category, entries]: by_category){
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b){
+      return a.second.wall_us > b.second.wall_us;
+    });
+    if(category == "type" && entries.size() > ntop_types_) entries.resize(ntop_types_);
+    o << sep << "  " << quoted(category) << ": [";
+    const char* sep2 = "\n    ";
+    for(const auto& [name, t]: entries){
+      o << sep2;
+      write_total(name, t);
+      sep2 = ",\n    ";
+    }
+    o << "\n  ]";
+    sep = ",\n";
+  }
+  o << "\n}\n";
+  o.close();
+  bool ok = !o.fail();
+
+  std::string trace_path = path_;
+  const std::string ext = ".json";
+  if(trace_path.size() > ext.size()
+     && trace_path.compare(trace_path.size() - ext.size(), ext.size(), ext) == 0){
+    trace_path.erase(trace_path.size() - ext.size());
+  }
+  trace_path += "-trace.json";
+
+  std::ofstream t(trace_path);
+  t << std::fixed << std::setprecision(3);
+  t << "{\"traceEvents\": [";
+  sep = "\n";
+  for(const auto& e: events_){
+    t << sep << "{\"ph\": \"X\", \"pid\": " << e.pid << ", \"tid\": " << e.tid
+      << ", \"cat\": " << quoted(e.category)
+      << ", \"name\": " << quoted(e.name)
+      << ", \"ts\": " << e.start_us
+      << ", \"dur\": " << e.wall_us
+      << ", \"args\": {\"cpu_ms\": " << e.cpu_us * 1.e-3
+      << ", \"allocations\": " << e.nallocs << "}}";
+    sep = ",\n";
+  }
+  t << "\n], \"displayTimeUnit\": \"ms\"}\n";
+  t.close();
+  ok &= !t.fail();
+
+  if(!ok){
+    std::cerr << "Error: failed to write the profiling files "
+              << path_ << " and " << trace_path << ".\n";
+  }
+  return ok;
+}
+
+void Profiler::start_worker(unsigned iworker){
+  if(!enabled_) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  in_forked_process = false;
+  worker_ = iworker + 1;
+  nallocs_at_start_ = nallocs();
+  events_.clear();
+  totals_.clear();
+  for(Counter* c = counters_; c; c = c->next_) c->total_ = total_t();
+}
+
+void Profiler::save(std::ostream& o) const{
+  std::lock_guard<std::mutex> lock(mutex_);
+  o << std::setprecision(17);
+  o << (enabled_ ? nallocs() - nallocs_at_start_ : 0) << "\n";
+  const auto& totals = all_totals();
+  o << totals.size() << "\n";
+  for(const auto& [key, t]: totals){
+    o << std::quoted(key.first) << " " << std::quoted(key.second) << " "
+      << t.count << " " << t.wall_us << " " << t.cpu_us << " " << t.nallocs << "\n";
+  }
+  o << events_.size() << "\n";
+  for(const auto& e: events_){
+    o << std::quoted(e.category) << " " << std::quoted(e.name) << " "
+      << e.start_us << " " << e.wall_us << " " << e.cpu_us << " "
+      << e.nallocs << " " << e.pid << " " << e.tid << "\n";
+  }
+}
+
+bool Profiler::merge(std::istream& i){
+  std::lock_guard<std::mutex> lock(mutex_);
+  unsigned long long n = 0;
+  size_t ntotals = 0;
+  i >> n >> ntotals;
+  worker_nallocs_ += n;
+  for(size_t j = 0; i && j < ntotals; ++j){
+    std::string category, name;
+    total_t t;
+    i >> std::quoted(category) >> std::quoted(name)
+      >> t.count >> t.wall_us >> t.cpu_us >> t.nallocs;
+    auto& total = totals_[std::make_pair(category, name)];
+    total.count += t.count;
+    total.wall_us += t.wall_us;
+    total.cpu_us += t.cpu_us;
+    total.nallocs += t.nallocs;
+  }
+  size_t nevents = 0;
+  i >> nevents;
+  for(size_t j = 0; i && j < nevents; ++j){
+    event_t e;
+    i >> std::quoted(e.category) >> std::quoted(e.name)
+      >> e.start_us >> e.wall_us >> e.cpu_us >> e.nallocs >> e.pid >> e.tid;
+    if(i) events_.push_back(e);
+  }
+  return !i.fail();
+}
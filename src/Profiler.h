@@ -0,0 +1,161 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <iosfwd>
+
+// Timing of the wrapit execution phases (--profile option).
+//
+// The time spent in a code block is recorded by a Profiler::Scope object
+// placed at its beginning. A scope records the wall time, the process CPU
+// time and the number of memory allocations (calls to the global operator
+// new) between its construction and its destruction.
+//
+// Scopes of the "phase" and "type" categories are recorded individually
+// and written as events in the Chrome trace format (to be displayed
+// with chrome://tracing or https://ui.perfetto.dev). The scopes of other
+// categories, used on hot paths, are only accumulated. The summary, with
+// the totals per phase and category and the most expensive types, is
+// written in JSON format.
+//
+// The scopes of the hot paths are accumulated in a Profiler::Counter
+// defined as a static variable at the instrumented place, such that
+// recording them neither allocates memory nor looks up the totals:
+//
+//   static Profiler::Counter counter("hot path", "veto matching");
+//   Profiler::Scope prof(counter);
+//
+// The profiler is disabled by default, in which case a scope costs a test
+// of a boolean. The records of the processes forked by the -j option are
+// sent back to the main process with the generation state (see save() and
+// merge()) and appear as separate processes in the trace.
+class Profiler{
+  struct total_t{
+    unsigned count = 0;
+    double wall_us = 0;
+    double cpu_us = 0;
+    unsigned long long nallocs = 0;
+  };
+
+public:
+  class Counter{
+  public:
+    // category and name must be string literals
+    Counter(const char* category, const char* name);
+
+    Counter(const Counter&) = delete;
+    Counter& operator=(const Counter&) = delete;
+
+  private:
+    friend class Profiler;
+    const char* category_;
+    const char* name_;
+    total_t total_;
+    //next counter of the list of the defined counters
+    Counter* next_;
+  };
+
+  class Scope{
+  public:
+    Scope(const char* category, const std::string& name);
+    Scope(const char* category, const char* name);
+    Scope(Counter& counter);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    void start();
+
+    bool active_;
+    const char* category_;
+    std::string name_;
+    Counter* counter_;
+    std::chrono::steady_clock::time_point wall0_;
+    double cpu0_;
+    unsigned long long nallocs0_;
+  };
+
+  static Profiler& instance();
+
+  // Enables the profiling. The summary will be written in path and the
+  // trace in path with the .json extension replaced by -trace.json, when
+  // the program exits. The memory allocations are counted from this call.
+  void enable(const std::string& path, unsigned ntop_types = 20);
+
+  bool enabled() const { return enabled_; }
+
+  // Writes the summary and trace files. Returns false on failure. Called
+  // at exit when the profiler is enabled.
+  bool write() const;
+
+  // To be called in a process forked for the code generation: the records
+  // inherited from the parent process are dropped and the new ones
+  // are labelled with the worker number iworker.
+  void start_worker(unsigned iworker);
+
+  // Writes the records of a worker process in o, to be read back
+  // by merge() in the main process.
+  void save(std::ostream& o) const;
+
+  // Adds the records saved by a worker process. Returns false if
+  // the input is corrupted.
+  bool merge(std::istream& i);
+
+  // Number of memory allocations performed since the profiler was enabled
+  static unsigned long long nallocs();
+
+private:
+  Profiler();
+
+  struct event_t{
+    std::string category;
+    std::string name;
+    double start_us;
+    double wall_us;
+    double cpu_us;
+    unsigned long long nallocs;
+    unsigned pid;
+    unsigned tid;
+  };
+
+  void record(const char* category, const std::string& name,
+              std::chrono::steady_clock::time_point wall0, double cpu0,
+              unsigned long long nallocs0);
+
+  void record(Counter& counter, std::chrono::steady_clock::time_point wall0,
+              double cpu0, unsigned long long nallocs0);
+
+  //totals of the recorded scopes, including the counters
+  std::map<std::pair<std::string, std::string>, total_t> all_totals() const;
+
+  static double cpu_time_us();
+
+  bool enabled_;
+  std::string path_;
+  unsigned ntop_types_;
+  std::chrono::steady_clock::time_point t0_;
+  //worker process number + 1, 0 for the main process
+  unsigned worker_;
+  //allocation count at the start of the worker process
+  unsigned long long nallocs_at_start_;
+  //allocations of the worker processes merged in the main process
+  unsigned long long worker_nallocs_;
+  mutable std::mutex mutex_;
+  std::vector<event_t> events_;
+  std::map<std::pair<std::string, std::string>, total_t> totals_;
+  //head of the list of the defined counters
+  Counter* counters_;
+};
+
+#endif //PROFILER_H not defined
@@ -0,0 +1,27 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#include "SignatureCache.h"
+
+const SignatureCache::variants_t*
+SignatureCache::find(const std::string& key) const{
+  auto it = entries_.find(key);
+  if(it == entries_.end()){
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  return &it->second;
+}
+
+const SignatureCache::variants_t&
+SignatureCache::add(const std::string& key, const std::array<std::string, 8>& sigs){
+  variants_t& v = entries_[key];
+  for(unsigned i = 0; i < sigs.size(); ++i){
+    //elements of an unordered_set are not moved by insertions
+    v[i] = &*strings_.insert(sigs[i]).first;
+  }
+  return v;
+}
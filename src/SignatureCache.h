@@ -0,0 +1,49 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#ifndef SIGNATURECACHE_H
+#define SIGNATURECACHE_H
+
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Cache of function signatures. For each function, identified by a key
+// made of the USR of its cursor and of the class it is wrapped for, the
+// eight variants of FunctionWrapper::signature() (with or without the cv
+// qualifiers, the static specifier and the type mapping) are computed
+// once and stored in a table of interned strings.
+class SignatureCache{
+public:
+  typedef std::array<const std::string*, 8> variants_t;
+
+  static unsigned variant(bool withconst, bool withstatic, bool aftermap){
+    return (withconst ? 1 : 0) | (withstatic ? 2 : 0) | (aftermap ? 4 : 0);
+  }
+
+  //Returns the signature variants recorded for key, nullptr if none.
+  const variants_t* find(const std::string& key) const;
+
+  //Records the signature variants of a function, indexed by variant().
+  const variants_t& add(const std::string& key, const std::array<std::string, 8>& sigs);
+
+  //To be called when the type mapping changes
+  void clear(){
+    entries_.clear();
+    strings_.clear();
+  }
+
+  unsigned hits() const { return hits_; }
+  unsigned misses() const { return misses_; }
+
+private:
+  std::unordered_set<std::string> strings_;
+  std::unordered_map<std::string, variants_t> entries_;
+  mutable unsigned hits_ = 0;
+  mutable unsigned misses_ = 0;
+};
+
+#endif //SIGNATURECACHE_H not defined
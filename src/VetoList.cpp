@@ -0,0 +1,80 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#include "VetoList.h"
+#include <iostream>
+
+extern int verbose;
+
+void VetoList::add(const std::string& v){
+  if(v.size() == 0) return;
+
+  lines_.insert(v);
+  const unsigned iline = nlines_++;
+  cache_.clear();
+
+  std::string::size_type ifirst = 0;
+
+  bool effect = true;
+  if(v[ifirst] == '+'){ //unveto
+    //+ prefix allows to undo a veto (e.g. from a regex)
+    //the last directive line has the last word.
+    effect = false;
+    has_unveto_ = true;
+    ++ifirst;
+  } else if(v[ifirst] == '-'){//veto, the default
+    ++ifirst;
+  }
+
+  if(v.size() <= ifirst) return;
+
+  if(v[ifirst] == '/'){ //regex
+    if(v[v.size()-1] != '/'){
+      std::cerr << "ERROR: syntax error in the veto file: missing an ending"
+        "slash on a line starting with a slash (/).\n";
+      exit(1);
+    }
+    auto re_ = v.substr(ifirst + 1, v.size() - 2 - ifirst);
+    regexes_.push_back(veto_regex_t{iline, effect, re_,
+                                    std::regex(re_, std::regex_constants::basic
+                                               | std::regex_constants::optimize)});
+  } else{
+    exact_[v.substr(ifirst)] = std::make_pair(iline, effect);
+  }
+}
+
+bool VetoList::vetoed(const std::string& signature) const{
+  auto it = cache_.find(signature);
+  if(it != cache_.end()) return it->second;
+  bool r = match(signature);
+  cache_.emplace(signature, r);
+  return r;
+}
+
+bool VetoList::match(const std::string& signature) const{
+  int iexact = -1;
+  bool exact_effect = false;
+  auto it = exact_.find(signature);
+  if(it != exact_.end()){
+    iexact = it->second.first;
+    exact_effect = it->second.second;
+    //without unveto directive, any match means a veto
+    if(!has_unveto_) return true;
+  }
+
+  //look for a regex appearing after the exact match in the file,
+  //starting from the end.
+  for(auto itre = regexes_.rbegin(); itre != regexes_.rend(); ++itre){
+    if(static_cast<int>(itre->iline) < iexact) break;
+    if(verbose > 5) std::cerr << "Debug: Comparing " << signature
+                              << " with grep-like regular expression "
+                              << itre->pattern << "\n";
+    if(std::regex_match(signature, itre->re)){
+      return itre->effect;
+    }
+  }
+
+  return iexact >= 0 ? exact_effect : false;
+}
@@ -0,0 +1,66 @@
+//-*- mode: c++; c-basic-offset: 2; indent-tabs-mode: nil; -*-
+// vim: noai:ts=2:sw=2:expandtab
+//
+// Copyright (C) 2021 Philippe Gras CEA/Irfu <philippe.gras@cern.ch>
+//
+#ifndef VETOLIST_H
+#define VETOLIST_H
+
+#include <string>
+#include <vector>
+#include <regex>
+#include <unordered_map>
+#include <unordered_set>
+
+// List of veto directives read from the veto file, compiled for fast
+// matching.
+//
+// A directive is either an exact signature or a grep-like regular
+// expression surrounded by slashes. It can be prefixed with '-' (veto,
+// the default) or '+' (unveto). When several directives match a
+// signature, the last one has the last word.
+class VetoList{
+public:
+  VetoList(): has_unveto_(false) {}
+
+  // Adds a directive. Exits the application in case of syntax error.
+  void add(const std::string& line);
+
+  // Checks if signature is vetoed.
+  bool vetoed(const std::string& signature) const;
+
+  // Checks if line is one of the directives, as written in the veto file.
+  bool has_line(const std::string& line) const{
+    return lines_.count(line) > 0;
+  }
+
+  bool empty() const { return nlines_ == 0; }
+
+private:
+  struct veto_regex_t{
+    unsigned iline;
+    bool effect;
+    std::string pattern;
+    std::regex re;
+  };
+
+  bool match(const std::string& signature) const;
+
+  //exact signature -> (line index, effect) of its last occurence
+  std::unordered_map<std::string, std::pair<unsigned, bool>> exact_;
+
+  //regular expressions in the order of the file
+  std::vector<veto_regex_t> regexes_;
+
+  std::unordered_set<std::string> lines_;
+
+  unsigned nlines_ = 0;
+
+  //true if at least one '+' directive is present
+  bool has_unveto_;
+
+  //cache of the matching results
+  mutable std::unordered_map<std::string, bool> cache_;
+};
+
+#endif //VETOLIST_H not defined
@@ -10,6 +10,7 @@
 #include <memory>
 #include <filesystem>
 #include <tuple>
+#include <set>
 #include <cxxopts.hpp>
 #include <ctime>
 #include <unistd.h>
@@ -21,6 +22,10 @@ using namespace std::string_view_literals;
 #include "utils.h"
 #include "uuid_utils.h"
 #include "cxxwrap_version.h"
+#include "Manifest.h"
+#include "md5sum.h"
+#include "Profiler.h"
+#include "BufferedFile.h"
 
 using namespace codetree;
 
@@ -116,11 +121,30 @@ int main(int argc, char* argv[]){
                                  "--help and clang --print-resource-dir). Default: ")
      + CodeTree::resolve_clang_resource_dir_path(CLANG_RESOURCE_DIR) + ".",
      cxxopts::value<std::string>())
-    ("u,update", "Enable update mode. In update mode, if a file to generate "
-     "already exist and there is no code changed, then the file including "
-     "its time stamp is preserved. The time stamp can then be used to "
-     "recompile modified files only during wrapper development of "
-     "large projects.")
+    ("u,update", "Enable update mode. In update mode, the code generation "
+     "is skipped altogether if the configuration and none of the header "
+     "files changed since the previous run, as recorded in the "
+     "jl<module_name>-manifest.txt file. In all modes, a file to generate "
+     "that already exists with no code change is preserved, including "
+     "its time stamp, so that only the modified files are recompiled.")
+    ("j,jobs", "Number of processes used to generate the wrapper code files. "
+     "Effective only when the code is split in several files (see "
+     "n_classes_per_file configuration parameter). The produced code "
+     "does not depend on this number. Also sets the number of threads used "
+     "to parse the input headers when n_parse_units is larger than 1.",
+     cxxopts::value<unsigned>()->default_value("1"))
+    ("profile", "Record the time spent and the number of memory allocations "
+     "in each phase of the execution, for the most expensive types and for "
+     "the header files, and write them in the given file in JSON format. A "
+     "trace in the Chrome format is written in a file with the same name, "
+     "with the .json extension replaced by -trace.json.",
+     cxxopts::value<std::string>())
+    ("auto-veto-build", "Compile the generated wrapper files with the build_cmd "
+     "command of the configuration, find the wrappers responsible for compilation "
+     "failures by bisection and write their signatures in the given file, in the "
+     "veto file format. Compilations are run in parallel using the number of "
+     "processes set with the -j option.",
+     cxxopts::value<std::string>())
     ("ignore-parsing-errors", "Force generation of code in presence of error in the "
      "C++ code interpretation. For debug purpose as the generated code will likely "
      "be invalid is such case.\n")
@@ -230,6 +254,8 @@ int main(int argc, char* argv[]){
     auto clang_features = read_vstring("clang_features");
     auto clang_opts     = read_vstring("clang_opts");
 
+    auto pch_cache_dir  = toml_config["pch_cache_dir"].value_or(std::string());
+
     auto lib_basename       = toml_config["lib_basename"].value_or(std::string("$(@__DIR__)/../deps/libjl") + module_name);
 
     std::string output_prefix = options["output-prefix"].as<std::string>();
@@ -250,10 +276,42 @@ int main(int argc, char* argv[]){
 
     auto n_classes_per_file = toml_config["n_classes_per_file"].value_or(-1);
 
+    auto n_balanced_files = toml_config["n_balanced_files"].value_or(0);
+
+    auto n_parse_units = toml_config["n_parse_units"].value_or(1);
+
+    auto lazy_method_registration = toml_config["lazy_method_registration"].value_or(false);
+
+    auto method_wrapper_strategy = toml_config["method_wrapper_strategy"].value_or(std::string("lambdas"));
+    if(method_wrapper_strategy != "lambdas" && method_wrapper_strategy != "ptr_adapter"){
+      std::cerr << "Warning: value '" << method_wrapper_strategy
+                << "' for configurable method_wrapper_strategy is not valid. "
+        "Valid values: lambdas, ptr_adapter.\n";
+      method_wrapper_strategy = "lambdas";
+    }
+
+    auto broadcast_methods = read_vstring("broadcast_methods");
+
+    auto vector_overloads = toml_config["vector_overloads"].value_or(false);
+
+    auto ccall_functions = read_vstring("ccall_functions");
+
+    auto gc_safe_functions = read_vstring("gc_safe_functions");
+
+    auto lib_split = toml_config["lib_split"].value_or(std::string("none"));
+    if(lib_split != "none" && lib_split != "namespace" && lib_split != "file"){
+      std::cerr << "Warning: value '" << lib_split
+                << "' for configurable lib_split is not valid. "
+        "Valid values: none, namespace, file.\n";
+      lib_split = "none";
+    }
+
     auto julia_names = read_vstring("julia_names");
 
     auto mapped_types = read_vstring("mapped_types");
 
+    auto isbits_types = read_vstring("isbits_types");
+
     auto cxx2cxxtypes = read_vstring("cxx2cxx_type_map");
 
     auto class_order_contraints = read_vstring("class_order_constraints");
@@ -264,10 +322,17 @@ int main(int argc, char* argv[]){
 
     auto propagation_mode  = toml_config["propagation_mode"].value_or("types"sv);
 
-    auto build_cmd  = toml_config["build_cmd"].value_or("echo No build command defined"sv);
+    auto build_cmd  = toml_config["build_cmd"].value_or(""sv);
 
     auto test_build = toml_config["test_build"].value_or(false);
 
+    if((test_build || options.count("auto-veto-build")) && build_cmd.size() == 0){
+      std::cerr << "Error: the test_build mode and the --auto-veto-build option "
+        "require the compilation command defined by the build_cmd configuration "
+        "parameter.\n";
+      return 1;
+    }
+
     auto build_nskips = toml_config["build_nskips"].value_or(0);
     auto build_nmax = toml_config["build_nmax"].value_or(-1);
     auto build_every = toml_config["build_every"].value_or(1);
@@ -276,6 +341,8 @@ int main(int argc, char* argv[]){
 
     auto verbosity = options["verbosity"].as<int>();
 
+    verbose = verbosity;
+
 
     //toml_config["verbosity"].value_or(0);
 
@@ -302,13 +369,13 @@ int main(int argc, char* argv[]){
     }
 
 
-    auto version = toml_config["version"].value_or(std::string());
+    auto module_version = toml_config["version"].value_or(std::string());
 
     if(options.count("get")){
       auto param = options["get"].as<std::string>();
       if(param == "cxxwrap_version")      std::cout << cxxwrap_version_str << "\n";
       else if(param == "module_name")     std::cout << module_name << "\n";
-      else if(param == "version")         std::cout << version << "\n";
+      else if(param == "version")         std::cout << module_version << "\n";
       else if(param == "lib_basname")     std::cout << lib_basename << "\n";
       else if(param == "export_jl_fname") std::cout << out_export_jl_fname << "\n";
       else if(param == "module_jl_fname") std::cout << out_jl_fname << "\n";
@@ -334,56 +401,81 @@ int main(int argc, char* argv[]){
         return 1;
     }
 
-    bool in_err = false;
-    auto open_mode = std::ofstream::out;
-    if(options.count("force") == 0){
-      open_mode |= std::ofstream::app;
+    //Checksum of everything, apart from the parsed header files,
+    //the generated code depends on
+    std::stringstream config_buf;
+    config_buf << toml_config << "\n";
+    //Command line options, but the ones that do not change the output.
+    //The --add-cfg parameters are already included in toml_config.
+    const std::set<std::string> no_output_options = {
+      "help", "version", "verbosity", "force", "cfgfile", "get", "add-cfg",
+      "update", "jobs", "profile"
+    };
+    for(const auto& opt: options.arguments()){
+      if(no_output_options.count(opt.key()) == 0){
+        config_buf << opt.key() << " " << opt.value() << "\n";
+      }
+    }
+    if(veto_list.size() > 0){
+      std::ifstream veto_file{std::string(veto_list)};
+      config_buf << veto_file.rdbuf();
     }
+    std::vector<unsigned char> config_md5;
+    md5sum_of_string(config_md5, config_buf.str());
+
+    Manifest manifest(version, md5hex(config_md5));
+    auto manifest_fpath = resolve_out_dir(std::string("jl") + module_name + "-manifest.txt");
+
+    if(options.count("update") && manifest.up_to_date(manifest_fpath)){
+      std::cerr << "Generated code is up to date, generation skipped. See "
+                << manifest_fpath << ".\n";
+      return 0;
+    }
+
+    CodeTree tree;
 
+    tree.set_force_mode(options.count("force") > 0);
+
+    bool in_err = false;
+
+    //The files are written when closed, only if their contents changed
     auto open_file = [&](const std::string& fname){
-      std::ofstream f(fname, open_mode);
-      if(f.tellp()!=0){
+      if(tree.is_in_the_way(fname)){
         std::cerr << "File " << fname << " is in the way, please move it or use the --force option to force its deletion.\n";
         in_err = true;
       }
-      return f;
+      return BufferedFile(fname);
     };
 
 
     auto out_jl_src = join_paths(out_jl_dir, out_jl_subdir);
     fs::create_directories(out_jl_src);
-    auto out_jl = open_file(join_paths(out_jl_src, out_jl_fname));
+    auto out_jl_fpath = join_paths(out_jl_src, out_jl_fname);
+    auto out_jl = open_file(out_jl_fpath);
 
-    std::ofstream out_export_jl_;
+    BufferedFile out_export_jl_;
     bool same_ = true;
     if(out_export_jl_fname.size() > 0){
       same_ = false;
+      manifest.add_output(join_paths(out_jl_src, out_export_jl_fname));
       out_export_jl_ = std::move(open_file(join_paths(out_jl_src, out_export_jl_fname)));
     }
     auto& out_export_jl = same_ ? out_jl : out_export_jl_;
 
-    std::ofstream out_report(out_report_fpath, open_mode);
-    if(out_report.tellp()!=0){
-      std::cerr << "File " << out_report_fpath
-                << " is in the way, please move it or use the --force option to force its deletion.\n";
-      in_err = true;
-    }
+    auto out_report = open_file(out_report_fpath);
 
     auto out_project_fpath = join_paths(out_jl_dir, out_project_fname);
-    std::ofstream out_project_toml(out_project_fpath, open_mode);
-    if(out_project_toml.tellp()!=0){
-      std::cerr << "File " << out_project_fpath
-                << " is in the way, please move it or use the --force option to force its deletion.\n";
-      in_err = true;
-    }
-
-    if(in_err) return -1;
-
-    verbose = verbosity;
+    auto out_project_toml = open_file(out_project_fpath);
 
-    CodeTree tree;
+    //to not overwrite the files of the previous generation on failure
+    auto discard_outputs = [&]{
+      for(auto f: {&out_jl, &out_export_jl_, &out_report, &out_project_toml}) f->discard();
+    };
 
-    tree.set_force_mode(options.count("force") > 0);
+    if(in_err){
+      discard_outputs();
+      return -1;
+    }
 
     tree.set_ignore_parsing_errors(options.count("ignore-parsing-errors") > 0);
 
@@ -391,6 +483,9 @@ int main(int argc, char* argv[]){
 
     tree.set_julia_names(julia_names);
     tree.set_mapped_types(mapped_types);
+
+    tree.set_isbits_types(isbits_types);
+
     tree.set_cxx2cxx_typemap(cxx2cxxtypes);
     tree.set_class_order_constraints(class_order_contraints);
 
@@ -411,6 +506,32 @@ int main(int argc, char* argv[]){
 
     tree.set_n_classes_per_file(n_classes_per_file);
 
+    tree.set_n_balanced_files(n_balanced_files);
+
+    tree.set_njobs(options["jobs"].as<unsigned>());
+
+    tree.set_n_parse_units(n_parse_units);
+
+    tree.set_lazy_method_registration(lazy_method_registration);
+
+    if(method_wrapper_strategy == "ptr_adapter"){
+      tree.set_method_wrapper_strategy(method_wrapper_strategy_t::ptr_adapter);
+    }
+
+    tree.set_broadcast_methods(broadcast_methods);
+
+    tree.set_vector_overloads(vector_overloads);
+
+    tree.set_ccall_functions(ccall_functions);
+
+    tree.set_gc_safe_functions(gc_safe_functions);
+
+    if(lib_split == "namespace"){
+      tree.set_lib_split(lib_split_t::namespaces);
+    } else if(lib_split == "file"){
+      tree.set_lib_split(lib_split_t::files);
+    }
+
     tree.set_module_name(module_name);
 
     tree.set_out_cxx_dir(out_cxx_dir);
@@ -460,6 +581,14 @@ int main(int argc, char* argv[]){
       tree.set_update_mode(true);
     }
 
+    if(pch_cache_dir.size() > 0){
+      tree.set_pch_cache_dir(resolve_out_dir(pch_cache_dir));
+    }
+
+    if(options.count("auto-veto-build")){
+      tree.set_auto_veto_build(options["auto-veto-build"].as<std::string>());
+    }
+
     for(const auto& s: extra_headers){
       tree.add_extra_headers(s);
     }
@@ -476,12 +605,57 @@ int main(int argc, char* argv[]){
       tree.add_export_veto_word(k);
     }
 
-    if(!tree.parse()) return -1;
-    tree.preprocess();
-    tree.generate_cxx();
-    tree.generate_jl(out_jl, out_export_jl, module_name, lib_basename);
-    tree.generate_project_file(out_project_toml, uuid, version);
+    if(options.count("profile")){
+      Profiler::instance().enable(options["profile"].as<std::string>());
+    }
+
+    {
+      Profiler::Scope prof("phase", "parse");
+      if(!tree.parse()){
+        discard_outputs();
+        return -1;
+      }
+    }
+
+    {
+      Profiler::Scope prof("phase", "preprocess");
+      tree.preprocess();
+    }
+
+    {
+      Profiler::Scope prof("phase", "generate_cxx");
+      tree.generate_cxx();
+    }
+
+    {
+      Profiler::Scope prof("phase", "generate_jl");
+      tree.generate_jl(out_jl, out_export_jl, module_name, lib_basename);
+      tree.generate_project_file(out_project_toml, uuid, module_version);
+    }
+
+    {
+      Profiler::Scope prof("phase", "report");
+      tree.report(out_report);
+    }
+
+    {
+      Profiler::Scope prof("phase", "test build");
+      if(!tree.run_test_build() || !tree.run_auto_veto_build()){
+        discard_outputs();
+        return 1;
+      }
+    }
 
-    tree.report(out_report);
+    out_jl.close();
+    out_export_jl_.close();
+    out_report.close();
+    out_project_toml.close();
+
+    for(const auto& f: tree.included_files()) manifest.add_input(f);
+    for(const auto& f: tree.generated_files()) manifest.add_output(f);
+    manifest.add_output(out_jl_fpath);
+    manifest.add_output(out_project_fpath);
+    manifest.add_output(out_report_fpath);
+    manifest.write(manifest_fpath);
   }
 }
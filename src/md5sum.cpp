@@ -30,3 +30,26 @@ void md5sum(std::vector<unsigned char>& md5, const std::string& filename,
   EVP_DigestFinal_ex(md5Context, md5.data(), &length);
   md5.resize(length);
 }
+
+void md5sum_of_string(std::vector<unsigned char>& md5, const std::string& data){
+  auto hash_algo = EVP_md5();
+  auto md5Context = EVP_MD_CTX_new();
+  EVP_DigestInit_ex(md5Context, hash_algo, NULL);
+  EVP_DigestUpdate(md5Context, data.data(), data.size());
+  md5.resize(EVP_MAX_MD_SIZE);
+  unsigned length;
+  EVP_DigestFinal_ex(md5Context, md5.data(), &length);
+  EVP_MD_CTX_free(md5Context);
+  md5.resize(length);
+}
+
+std::string md5hex(const std::vector<unsigned char>& md5){
+  static const char digits[] = "0123456789abcdef";
+  std::string r;
+  r.reserve(2 * md5.size());
+  for(auto c: md5){
+    r += digits[c >> 4];
+    r += digits[c & 0xF];
+  }
+  return r;
+}
@@ -4,3 +4,8 @@
 void md5sum(std::vector<unsigned char>& md5, const std::string& filename,
             int nlineskip = 0);
 
+//Computes the md5 checksum of a string contents
+void md5sum_of_string(std::vector<unsigned char>& md5, const std::string& data);
+
+//Converts a checksum into its hexadecimal representation
+std::string md5hex(const std::vector<unsigned char>& md5);
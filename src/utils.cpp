@@ -130,6 +130,32 @@ std::string jl_type_name(const CXType& t){
   return jl_type_name(s);
 }
 
+std::string jl_arithmetic_type(CXType type){
+  switch(clang_getCanonicalType(type).kind){
+  case CXType_Char_S:    return "Cchar";
+  case CXType_Char_U:    return "Cchar";
+  case CXType_SChar:     return "Int8";
+  case CXType_UChar:     return "UInt8";
+  case CXType_Short:     return "Cshort";
+  case CXType_UShort:    return "Cushort";
+  case CXType_Int:       return "Cint";
+  case CXType_UInt:      return "Cuint";
+  case CXType_Long:      return "Clong";
+  case CXType_ULong:     return "Culong";
+  case CXType_LongLong:  return "Clonglong";
+  case CXType_ULongLong: return "Culonglong";
+  case CXType_Float:     return "Cfloat";
+  case CXType_Double:    return "Cdouble";
+  default:               return "";
+  }
+}
+
+std::string jl_identifier(const std::string& name){
+  static std::regex re("[A-Za-z_][A-Za-z_0-9]*!?");
+  if(std::regex_match(name, re)) return name;
+  else return "var\"" + name + "\"";
+}
+
 void replace(std::string& s, const std::string& to_replace,
              const std::string& replacement){
   auto pos = s.find(to_replace);
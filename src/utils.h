@@ -65,6 +65,16 @@ std::string str(const CXString& x);
 std::string jl_type_name(const std::string& s);
 std::string jl_type_name(const CXType& t);
 
+//Julia name as it must be written in Julia code: names that are not plain
+//identifiers, like the jl_type_name() of a type of a namespace, are written
+//with the var"..." syntax.
+std::string jl_identifier(const std::string& name);
+
+//Julia type of an arithmetic type (C type aliases like Cint and
+//Cdouble), as used by the batched function variants, the vector
+//overloads and the isbits structs. Empty string for other types.
+std::string jl_arithmetic_type(CXType type);
+
 std::string fully_qualified_name(CXCursor c);
 
 std::string fully_qualified_name(CXType type);
@@ -0,0 +1,26 @@
+// Light classes around a class whose wrapper is much more expensive to
+// compile: with n_balanced_files = 3, the expensive class gets a file
+// of its own.
+
+struct Light1 { int f() const { return 1; } };
+struct Light2 { int f() const { return 2; } };
+struct Light3 { int f() const { return 3; } };
+
+struct Heavy {
+  Heavy(int a = 1, int b = 2, int c = 3): sum_(a + b + c) {}
+  int value() const { return sum_; }
+  int f0(int a = 0, int b = 0, int c = 0) const { return sum_ + a + b + c; }
+  int f1(int a = 0, int b = 0, int c = 0) const { return sum_ + a + b + c; }
+  int f2(int a = 0, int b = 0, int c = 0) const { return sum_ + a + b + c; }
+  int f3(int a = 0, int b = 0, int c = 0) const { return sum_ + a + b + c; }
+  int f4(int a = 0, int b = 0, int c = 0) const { return sum_ + a + b + c; }
+  int f5(int a = 0, int b = 0, int c = 0) const { return sum_ + a + b + c; }
+private:
+  int sum_;
+};
+
+struct Light4 { int f() const { return 4; } };
+struct Light5 { int f() const { return 5; } };
+struct Light6 { int f() const { return 6; } };
+
+inline int answer(){ return 42; }
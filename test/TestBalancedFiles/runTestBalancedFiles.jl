@@ -0,0 +1,47 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestBalancedFiles")
+using TestBalancedFiles
+
+const M = TestBalancedFiles
+
+src_dir = joinpath(@__DIR__, "build", "libTestBalancedFiles", "src")
+
+# Wrapper classes defined in a generated file
+wrapper_classes(fname) = [m[1] for m in eachmatch(r"^struct (Jl\w+): public Wrapper"m,
+                                                  read(joinpath(src_dir, fname), String))]
+
+function runtest()
+    @testset "Balanced file split test" begin
+        # The generated bindings load and work
+        @test [M.f(M.Light1()), M.f(M.Light2()), M.f(M.Light3()),
+               M.f(M.Light4()), M.f(M.Light5()), M.f(M.Light6())] == 1:6
+        h = M.Heavy()
+        @test M.value(h) == 6
+        @test M.value(M.Heavy(2)) == 7
+        @test M.f0(h, 1) == 7
+        @test M.f5(h, 1, 2, 3) == 12
+        @test M.answer() == 42
+
+        # The class wrappers are split in n_balanced_files files
+        files = sort(filter(f -> occursin(r"^JlClasses_\d{3}\.cxx$", f), readdir(src_dir)))
+        @test files == ["JlClasses_000.cxx", "JlClasses_001.cxx", "JlClasses_002.cxx"]
+        classes = [wrapper_classes(f) for f in files]
+        @test sort(vcat(classes...)) == sort(["JlLight$i" for i in 1:6] ∪ ["JlHeavy"])
+
+        # in the type order, the expensive class alone in its file
+        @test classes == [["JlLight1", "JlLight2", "JlLight3"], ["JlHeavy"],
+                          ["JlLight4", "JlLight5", "JlLight6"]]
+        @test wrapper_classes("JlGlobals.cxx") == ["JlGlobal"]
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
@@ -0,0 +1,9 @@
+struct A {
+  A(double s): scale_(s) {}
+  double scaled(double x) const { return scale_ * x; }
+  double affine(double x, const double& y) const { return scale_ * x + y; }
+private:
+  double scale_;
+};
+
+double weighted(double x, int w){ return w * x; }
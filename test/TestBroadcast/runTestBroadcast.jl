@@ -0,0 +1,42 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestBroadcast")
+using TestBroadcast
+
+const M = TestBroadcast
+
+function runtest()
+    @testset "Batched variant test" begin
+        a = M.A(2.0)
+        x = [1.0, -0.5, 3.0]
+        y = [0.5, 1.0, 2.0]
+        w = Int32[1, 2, 3]
+
+        # the batched variants loop over the vectors in C++
+        @test M.scaled_batch(a, x) == [M.scaled(a, xi) for xi in x]
+        @test M.affine_batch(a, x, y) == [M.affine(a, xi, yi) for (xi, yi) in zip(x, y)]
+        @test M.weighted_batch(x, w) == [M.weighted(xi, wi) for (xi, wi) in zip(x, w)]
+        @test_throws Exception M.affine_batch(a, x, y[1:2])
+
+        # a broadcast call over vectors is routed to the batched variant,
+        # which returns the result vector instead of a lazy Broadcasted object
+        @test Base.broadcasted(M.scaled, a, x) isa Vector{Float64}
+        @test Base.broadcasted(M.weighted, x, w) isa Vector{Float64}
+        @test M.scaled.(a, x) == [M.scaled(a, xi) for xi in x]
+        @test M.affine.(a, x, y) == [M.affine(a, xi, yi) for (xi, yi) in zip(x, y)]
+        @test M.weighted.(x, w) == [M.weighted(xi, wi) for (xi, wi) in zip(x, w)]
+
+        # other broadcasts are not affected
+        @test M.weighted.(x, 2) == 2 .* x
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
@@ -0,0 +1,16 @@
+// The declarations in the WRAPIT blocks are seen by wrapit, which defines
+// the WRAPIT macro when parsing the header, but not by the compiler: their
+// wrappers fail to compile.
+
+struct A {
+  int f() const { return 1; }
+#ifdef WRAPIT
+  int hidden() const;
+#endif
+};
+
+inline int twice(int i){ return 2 * i; }
+
+#ifdef WRAPIT
+int hidden_global(int i);
+#endif
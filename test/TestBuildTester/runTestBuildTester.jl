@@ -0,0 +1,99 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestBuildTester")
+using TestBuildTester
+import CxxWrap
+
+const M = TestBuildTester
+
+# wrapit command, as found by the cmake configuration (WRAPIT cache variable)
+wrapit = let cache = read(joinpath(@__DIR__, "build", "CMakeCache.txt"), String)
+    m = match(r"^WRAPIT:[A-Z]+=(.+)$"m, cache)
+    m === nothing && error("WRAPIT is not defined in the CMake cache of the test build")
+    String(m[1])
+end
+
+# Output area of the test builds, separated from the build area of
+# the TestBuildTester module
+out_dir = joinpath(@__DIR__, "build", "build_test")
+veto_out = joinpath(out_dir, "auto-veto.txt")
+
+# Compilation command of the generated code
+julia_inc = joinpath(Sys.BINDIR, Base.INCLUDEDIR, "julia")
+cxxwrap_inc = joinpath(CxxWrap.prefix_path(), "include")
+build_cmd = "c++ -std=c++17 -I$julia_inc -I$cxxwrap_inc -I$(@__DIR__)"
+
+# Runs wrapit and returns its success status and its error output
+function run_wrapit(opts)
+    err = Pipe()
+    p = run(pipeline(ignorestatus(Cmd(`$wrapit --force --output-prefix $out_dir $opts TestBuildTester.wit`,
+                                      dir=@__DIR__)), stderr=err))
+    close(err.in)
+    (success(p), read(err, String))
+end
+
+# Signatures of a veto file
+veto_lines(fname) = sort(filter(l -> !isempty(l) && !startswith(l, "#"), readlines(fname)))
+
+function runtest()
+    @testset "Test build and auto-veto-build test" begin
+        @test M.f(M.A()) == 1
+        @test M.twice(2) == 4
+
+        rm(out_dir, force=true, recursive=true)
+        mkpath(out_dir)
+
+        # Without build_cmd, the compilations cannot be tested
+        ok, log = run_wrapit(["--add-cfg", "test_build=true"])
+        @test !ok
+        @test occursin("build_cmd", log)
+        ok, log = run_wrapit(["--auto-veto-build", veto_out])
+        @test !ok
+        @test occursin("build_cmd", log)
+        @test !isfile(veto_out)
+
+        # A broken build_cmd is detected before the bisection
+        ok, log = run_wrapit(["--add-cfg", "build_cmd=\"false\"", "--auto-veto-build", veto_out])
+        @test !ok
+        @test occursin("prefix header alone fails", log)
+        @test !isfile(veto_out)
+
+        cmd_cfg = ["--add-cfg", "build_cmd=\"$build_cmd\""]
+        no_veto = ["--add-cfg", "veto_list=\"\""]
+
+        # The wrappers of the hidden declarations fail to compile
+        ok, log = run_wrapit([cmd_cfg; no_veto; "--add-cfg"; "test_build=true"])
+        @test !ok
+        @test all(s -> occursin(s, log), veto_lines("veto.txt"))
+        @test !occursin("int A::f()", log)
+
+        # and are found by bisection
+        ok, log = run_wrapit([cmd_cfg; no_veto; "--auto-veto-build"; veto_out])
+        @test ok
+        @test veto_lines(veto_out) == veto_lines("veto.txt")
+
+        # including when the methods go to the shared libraries of lib_split
+        veto_split = joinpath(out_dir, "auto-veto-split.txt")
+        ok, log = run_wrapit([cmd_cfg; no_veto; "--add-cfg"; "lib_split=\"namespace\"";
+                              "--auto-veto-build"; veto_split])
+        @test ok
+        @test veto_lines(veto_split) == veto_lines("veto.txt")
+        @test !occursin("could not be attributed", log)
+
+        # The generated veto file excludes them
+        ok, log = run_wrapit([cmd_cfg; "--add-cfg"; "veto_list=\"$veto_out\"";
+                              "--add-cfg"; "test_build=true"])
+        @test ok
+        @test occursin("test build succeeded", log)
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
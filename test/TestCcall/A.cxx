@@ -0,0 +1,55 @@
+#include "A.h"
+#include <julia.h>
+#include <cmath>
+#include <stdexcept>
+
+double add(double x, double y){ return x + y; }
+
+int scale(int x, int factor){ return x * factor; }
+
+long Counter::twice(long n){ return 2 * n; }
+
+static int state = 0;
+
+void set_state(int v){ state = v; }
+
+int half(int x){ return x / 2; }
+
+long half(long x){ return -(x / 2); }
+
+int get_state(){ return state; }
+
+double checked_sqrt(double x){
+  if(x < 0) throw std::domain_error("checked_sqrt: negative argument");
+  if(x == 0) throw 0;
+  return std::sqrt(x);
+}
+
+double sum_of(const Counter&, double x){ return x; }
+
+static int current_gc_state(){
+  //the function names are parenthesized as in the generated Wrapper.h
+  int8_t s = (jl_gc_safe_enter)();
+  (jl_gc_safe_leave)(s);
+  return s;
+}
+
+int Counter::gc_state() const { return current_gc_state(); }
+
+int gc_state(){ return current_gc_state(); }
+
+int gc_state_default(){ return current_gc_state(); }
+
+int safe_state_of(double){ return current_gc_state(); }
+
+int safe_state_count(const std::vector<double>& x){
+  return current_gc_state() != 0 ? x.size() : 0;
+}
+
+std::vector<int> safe_states(int n){ return std::vector<int>(n, current_gc_state()); }
+
+double slow_identity(double x){
+  volatile int n = 0;
+  for(int i = 0; i < 1000; ++i) n = n + 1;
+  return x;
+}
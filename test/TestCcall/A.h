@@ -0,0 +1,39 @@
+#include <vector>
+
+double add(double x, double y);
+
+int scale(int x, int factor = 3);
+
+struct Counter {
+  static long twice(long n);
+  //GC state of the calling thread, see gc_state()
+  int gc_state() const;
+};
+
+void set_state(int v);
+
+//overloads with the same Julia method: called with the exact types
+int half(int x);
+long half(long x);
+
+int get_state();
+
+//throws std::domain_error for a negative argument, an int for 0
+double checked_sqrt(double x);
+
+//argument not supported by ccall, wrapped with CxxWrap
+double sum_of(const Counter&, double x);
+
+//GC state of the calling thread during the call: non-zero if it is
+//in GC-safe state
+int gc_state();
+int gc_state_default();
+
+//GC state in the batched and std::vector variants
+int safe_state_of(double x);
+int safe_state_count(const std::vector<double>& x);
+std::vector<int> safe_states(int n);
+
+//slow identity, for the batched call run while the GC collects in
+//another thread
+double slow_identity(double x);
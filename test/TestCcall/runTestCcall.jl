@@ -0,0 +1,98 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestCcall")
+using TestCcall
+import Libdl
+
+const M = TestCcall
+
+# Long batched call of a GC-safe function while another thread runs the
+# collector: the results must not be written to a collected array
+function gc_stress()
+    x = collect(1.0:100_000.0)
+    stop = Threads.Atomic{Bool}(false)
+    collector = Threads.@spawn while !stop[]
+        garbage = [Vector{Float64}(undef, 1000) for _ in 1:100]
+        GC.gc()
+    end
+    ok = true
+    for _ in 1:20
+        ok &= M.slow_identity_batch(x) == x
+    end
+    stop[] = true
+    wait(collector)
+    ok
+end
+
+# runs gc_stress with two threads, in a child process if needed
+function gc_stress_test()
+    Threads.nthreads() >= 2 && return gc_stress()
+    cmd = `$(Base.julia_cmd()) --threads=2 --project=$(Base.active_project()) $(@__FILE__) --gc-stress`
+    success(pipeline(cmd, stdout=stderr))
+end
+
+function runtest()
+    @testset "ccall functions test" begin
+        @test M.add(1.5, 2.0) == 3.5
+        @test M.scale(Int32(2)) == 6
+        @test M.scale(Int32(2), Int32(5)) == 10
+        @test M.Counter!twice(21) == 42
+        M.set_state(Int32(7))
+        @test M.get_state() == 7
+
+        # The arguments are converted to the C types by @ccall
+        @test M.add(1, 2) === 3.0
+        @test M.add(1.5f0, 2) === 3.5
+        @test M.scale(2) === Int32(6)
+        @test M.scale(UInt8(2), 5) === Int32(10)
+        @test_throws InexactError M.scale(2^40)
+        @test_throws MethodError M.scale(2.5)
+        M.set_state(8)
+        @test M.get_state() == 8
+
+        # overloads defining the same Julia method take the exact types
+        @test M.half(Int32(8)) == 4
+        @test M.half(Clong(8)) == -4
+        @test length(methods(M.half)) == 2
+
+        # C++ exceptions are raised as Julia errors
+        @test M.checked_sqrt(4.0) == 2.0
+        @test_throws ErrorException("checked_sqrt: negative argument") M.checked_sqrt(-1.0)
+        @test_throws ErrorException M.checked_sqrt(0.0)
+        @test M.checked_sqrt(9.0) == 3.0
+
+        # The thunks are exported by the wrapper library
+        lib = Libdl.dlopen(M.__wrapit_lib)
+        if Sys.islinux()
+            @test Libdl.dlsym_e(lib, :jlTestCcall__Z3adddd) != C_NULL
+            @test Libdl.dlsym_e(lib, :jlTestCcall__Z5scaleii_1) != C_NULL
+        end
+        @test length(methods(M.scale)) == 2
+
+        # functions unsupported by ccall are wrapped with CxxWrap
+        @test M.sum_of(M.Counter(), 1.5) == 1.5
+
+        # functions listed in gc_safe_functions run in GC-safe state
+        @test M.gc_state() != 0
+        @test M.gc_state(M.Counter()) != 0
+        @test M.gc_state_default() == 0
+        @test all(!=(0), M.safe_state_of_batch([1.0, 2.0]))
+        @test M.safe_state_count([1.0, 2.0, 3.0]) == 3
+        @test all(!=(0), M.safe_states_array(Int32(2)))
+        GC.gc()
+        @test M.add(1.0, 1.0) == 2.0
+        @test gc_stress_test()
+    end
+end
+
+if "--gc-stress" in ARGS
+    exit(gc_stress() ? 0 : 1)
+elseif "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
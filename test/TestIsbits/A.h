@@ -0,0 +1,47 @@
+struct Point {
+  double x;
+  double y;
+  int tag;
+};
+
+struct Segment {
+  Point a;
+  Point b;
+  float weights[3];
+};
+
+class Mover {
+public:
+  Mover(double dx): dx_(dx) {}
+  Point shifted(Point p) const { return Point{p.x + dx_, p.y, p.tag}; }
+private:
+  double dx_;
+};
+
+Point midpoint(Point p, Point q){
+  return Point{(p.x + q.x) / 2, (p.y + q.y) / 2, (p.tag + q.tag) / 2};
+}
+
+Segment make_segment(Point a, Point b){
+  return Segment{a, b, {1.f, 2.f, 3.f}};
+}
+
+double weighted_length(Segment s){
+  double dx = s.b.x - s.a.x;
+  double dy = s.b.y - s.a.y;
+  return (dx * dx + dy * dy) * (s.weights[0] + s.weights[1] + s.weights[2]);
+}
+
+// Arrays of records, passed as a pointer and a number of elements
+int total_tag(const Point* points, int n){
+  int r = 0;
+  for(int i = 0; i < n; ++i) r += points[i].tag;
+  return r;
+}
+
+void translate_all(Point* points, int n, double dx, double dy){
+  for(int i = 0; i < n; ++i){
+    points[i].x += dx;
+    points[i].y += dy;
+  }
+}
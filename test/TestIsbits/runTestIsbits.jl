@@ -0,0 +1,55 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestIsbits")
+using TestIsbits
+
+using CxxWrap: CxxPtr, ConstCxxPtr
+
+const M = TestIsbits
+
+function runtest()
+    @testset "isbits record mapping test" begin
+        # the records are plain Julia structs with the C++ layout
+        @test isbitstype(M.Point)
+        @test isbitstype(M.Segment)
+        @test fieldnames(M.Point) == (:x, :y, :tag)
+        @test fieldtype(M.Point, :tag) == Int32
+        @test fieldtype(M.Segment, :weights) == NTuple{3, Float32}
+        @test sizeof(M.Point) == 24
+
+        # passed to C++ and returned by value
+        p = M.Point(1.0, 2.0, 3)
+        q = M.midpoint(p, M.Point(3.0, 6.0, 5))
+        @test q isa M.Point
+        @test (q.x, q.y, q.tag) == (2.0, 4.0, 4)
+
+        r = M.shifted(M.Mover(0.5), p)
+        @test (r.x, r.y, r.tag) == (1.5, 2.0, 3)
+
+        # nested records and fixed-size arrays
+        s = M.make_segment(p, q)
+        @test s.a == p
+        @test s.b == q
+        @test s.weights == (1.0f0, 2.0f0, 3.0f0)
+        @test M.weighted_length(s) == (1.0^2 + 2.0^2) * 6
+
+        # contiguous vectors of records: the C++ functions read and modify
+        # the elements of the Julia vector in place
+        v = [M.Point(i, -i, i) for i in 1:3]
+        GC.@preserve v begin
+            @test M.total_tag(ConstCxxPtr{M.Point}(pointer(v)), length(v)) == 6
+            M.translate_all(CxxPtr{M.Point}(pointer(v)), length(v), 0.5, 1.0)
+        end
+        @test [(x.x, x.y, x.tag) for x in v] == [(i + 0.5, 1.0 - i, i) for i in 1:3]
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
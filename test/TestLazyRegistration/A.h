@@ -0,0 +1,17 @@
+struct A {
+  A(int i): i_(i) {}
+  int value() const { return i_; }
+  void set_value(int i) { i_ = i; }
+  int add(int j, int k = 10) const { return i_ + j + k; }
+private:
+  int i_;
+};
+
+struct B {
+  B(): x_(1.5) {}
+  double x() const { return x_; }
+private:
+  double x_;
+};
+
+int twice(int i){ return 2 * i; }
@@ -0,0 +1,43 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestLazyRegistration")
+using TestLazyRegistration
+
+const M = TestLazyRegistration
+
+function runtest()
+    @testset "Lazy method registration test" begin
+        # Only the types and constructors are registered at module load
+        @test isempty(M.__wrapit_loaded_groups)
+
+        a = M.A(3)
+        @test isempty(M.__wrapit_loaded_groups)
+
+        # First call of a method of A: loads the methods of A
+        @test M.value(a) == 3
+        @test length(M.__wrapit_loaded_groups) == 1
+        M.set_value(a, 5)
+        @test M.value(a) == 5
+        @test M.add(a, 1) == 16
+        @test M.add(a, 1, 2) == 8
+
+        # Methods of B and global functions are in their own groups
+        b = M.B()
+        @test M.x(b) == 1.5
+        @test M.twice(4) == 8
+        @test length(M.__wrapit_loaded_groups) == 3
+
+        # Calls with arguments of unwrapped types are not silently accepted
+        @test_throws MethodError M.value(b)
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
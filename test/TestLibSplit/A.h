@@ -0,0 +1,21 @@
+// Two method groups with lib_split = "namespace": geo, for the classes of
+// the geo namespace, and global, for the global classes and functions.
+
+struct A {
+  A(int v): v_(v){}
+  int value() const { return v_; }
+private:
+  int v_;
+};
+
+inline int twice(int i){ return 2 * i; }
+
+namespace geo {
+  class Square {
+  public:
+    Square(double side): side_(side){}
+    double area() const { return side_ * side_; }
+  private:
+    double side_;
+  };
+}
@@ -0,0 +1,72 @@
+using Test
+using Serialization
+using Libdl
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestLibSplit")
+using TestLibSplit
+
+const M = TestLibSplit
+
+# wrapit command, as found by the cmake configuration (WRAPIT cache variable)
+wrapit = let cache = read(joinpath(@__DIR__, "build", "CMakeCache.txt"), String)
+    m = match(r"^WRAPIT:[A-Z]+=(.+)$"m, cache)
+    m === nothing && error("WRAPIT is not defined in the CMake cache of the test build")
+    String(m[1])
+end
+
+deps_dir = joinpath(@__DIR__, "build", "TestLibSplit", "deps")
+
+# Tells if the library of a method group is loaded
+group_loaded(group) = any(l -> occursin("libjlTestLibSplit_$group.", l), Libdl.dllist())
+
+# Method groups and their source files listed by the --cmake output
+# of wrapit with lib_split = "file"
+function file_groups()
+    out_dir = joinpath(@__DIR__, "build", "split_by_file")
+    rm(out_dir, force=true, recursive=true)
+    run(Cmd(`$wrapit --force --cmake --add-cfg "lib_split=\"file\"" --output-prefix $out_dir TestLibSplit.wit`,
+            dir=@__DIR__))
+    cmake = read(joinpath(out_dir, "wrapit.cmake"), String)
+    groups = split(match(r"set\(WRAPIT_LIB_GROUPS([^)]*)\)", cmake)[1])
+    Dict(g => split(match(Regex("set\\(WRAPIT_LIB_$(g)_SOURCES([^)]*)\\)"), cmake)[1])
+         for g in groups)
+end
+
+function runtest()
+    @testset "Method libraries test" begin
+        for group in ("global", "geo")
+            @test isfile(joinpath(deps_dir, "libjlTestLibSplit_$group.$(Libdl.dlext)"))
+        end
+
+        # The types and constructors are registered by the core library
+        a = M.A(3)
+        s = M.geo!Square(2.)
+        @test !group_loaded("global")
+        @test !group_loaded("geo")
+
+        # The first call of a method loads the library of its group
+        @test M.value(a) == 3
+        @test group_loaded("global")
+        @test !group_loaded("geo")
+        @test M.twice(4) == 8
+        @test M.area(s) == 4.
+        @test group_loaded("geo")
+
+        # One group per wrapper file with lib_split = "file"
+        groups = file_groups()
+        @test length(groups) > 1
+        for (group, sources) in groups
+            @test !isempty(sources)
+            @test all(f -> occursin("define_julia_module_", read(f, String)), sources)
+        end
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
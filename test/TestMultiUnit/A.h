@@ -0,0 +1,7 @@
+#include "Common.h"
+
+class A: public Base {
+public:
+  real_t value() const { return 1.5; }
+  Color color() const { return green; }
+};
@@ -0,0 +1,6 @@
+#include "Common.h"
+
+class B: public Base {
+public:
+  index_t n_items() const { return 3; }
+};
@@ -0,0 +1,3 @@
+#include "Common.h"
+
+inline real_t add_index(real_t a, index_t b){ return a + b; }
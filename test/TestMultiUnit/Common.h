@@ -0,0 +1,41 @@
+#ifndef COMMON_H
+#define COMMON_H
+
+#include <vector>
+
+// Declarations included by the three input headers, visited in each
+// translation unit
+
+enum Color { red, green, blue };
+
+typedef double real_t;
+using index_t = int;
+
+class Base {
+public:
+  Base(): id_(0){}
+  int id() const { return id_; }
+  void set_id(index_t i){ id_ = i; }
+private:
+  int id_;
+};
+
+template<typename T, typename U>
+struct Pair {
+  T head() const { return T(); }
+};
+
+//partial specialization
+template<typename T>
+struct Pair<T, T> {
+  T head() const { return T(1); }
+};
+
+template<typename T>
+using Vec = std::vector<T>;
+
+inline real_t scale(real_t x){ return 2. * x; }
+
+inline int counter = 0;
+
+#endif //COMMON_H not defined
@@ -0,0 +1,62 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestMultiUnit")
+using TestMultiUnit
+
+const M = TestMultiUnit
+
+# wrapit command, as found by the cmake configuration (WRAPIT cache variable)
+wrapit = let cache = read(joinpath(@__DIR__, "build", "CMakeCache.txt"), String)
+    m = match(r"^WRAPIT:[A-Z]+=(.+)$"m, cache)
+    m === nothing && error("WRAPIT is not defined in the CMake cache of the test build")
+    String(m[1])
+end
+
+# Generates the code with the input headers parsed in nunits translation
+# units and returns the signatures of the wrapped entities, as written in
+# the comments of the generated code.
+function wrapped_signatures(nunits)
+    out_dir = joinpath(@__DIR__, "build", "units$nunits")
+    rm(out_dir, force=true, recursive=true)
+    run(Cmd(`$wrapit --force --add-cfg "n_parse_units=$nunits" --output-prefix $out_dir TestMultiUnit.wit`,
+            dir=@__DIR__))
+    signatures = String[]
+    for (dir, _, fnames) in walkdir(out_dir), f in filter(endswith(".cxx"), fnames)
+        for l in eachline(joinpath(dir, f))
+            m = match(r"// signature to use in the veto (?:list|file): (.*)", l)
+            m === nothing || push!(signatures, m[1])
+        end
+    end
+    sort(signatures)
+end
+
+function runtest()
+    @testset "Multi-unit parsing test" begin
+        a = M.A()
+        M.set_id(a, 2)
+        @test M.id(a) == 2
+        @test M.value(a) == 1.5
+        @test M.color(a) == M.green
+        b = M.B()
+        @test M.n_items(b) == 3
+        @test M.scale(2.) == 4.
+        @test M.add_index(1.5, 2) == 3.5
+        @test M.counter() == 0
+
+        single = wrapped_signatures(1)
+        multi = wrapped_signatures(3)
+        @test !isempty(single)
+        @test multi == single
+        @test allunique(multi)
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
@@ -0,0 +1,63 @@
+#include <vector>
+
+struct Point {
+  double x;
+  double y;
+};
+
+enum class Unit { mm, cm, m };
+
+class Shape {
+public:
+  virtual ~Shape(){}
+  virtual double area() const { return 0.; }
+  double scaled_area(double k = 2.) const { return k * area(); }
+};
+
+class Square: public Shape {
+public:
+  Square(double side = 1.): side_(side){}
+  double area() const override { return side_ * side_; }
+  double side() const { return side_; }
+  std::vector<double> sides() const { return std::vector<double>(4, side_); }
+private:
+  double side_;
+};
+
+class Circle: public Shape {
+public:
+  Circle(double r): r_(r){}
+  double area() const override { return 3. * r_ * r_; }
+  Point center() const { return Point{1., 2.}; }
+  void move(const Point& p){ r_ += 0. * p.x; }
+private:
+  double r_;
+};
+
+template<typename T>
+class Holder {
+public:
+  Holder(): value_(){}
+  T get() const { return value_; }
+  void set(const T& v){ value_ = v; }
+private:
+  T value_;
+};
+
+class Box {
+public:
+  Holder<int>& holder(){ return holder_; }
+  Unit unit() const { return Unit::cm; }
+private:
+  Holder<int> holder_;
+};
+
+inline double hypot2(double x, double y){ return x * x + y * y; }
+
+inline double total(const std::vector<double>& v){
+  double s = 0.;
+  for(auto x: v) s += x;
+  return s;
+}
+
+inline int twice(int i){ return 2 * i; }
@@ -0,0 +1,65 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestParallelGeneration")
+using TestParallelGeneration
+
+const M = TestParallelGeneration
+
+# wrapit command, as found by the cmake configuration (WRAPIT cache variable)
+wrapit = let cache = read(joinpath(@__DIR__, "build", "CMakeCache.txt"), String)
+    m = match(r"^WRAPIT:[A-Z]+=(.+)$"m, cache)
+    m === nothing && error("WRAPIT is not defined in the CMake cache of the test build")
+    String(m[1])
+end
+
+# Generates the code with njobs processes, in an output area separated
+# from the build area of the TestParallelGeneration module
+function generate(njobs)
+    out_dir = joinpath(@__DIR__, "build", "jobs$njobs")
+    rm(out_dir, force=true, recursive=true)
+    run(Cmd(`$wrapit --force -j $njobs --output-prefix $out_dir TestParallelGeneration.wit`,
+            dir=@__DIR__))
+    out_dir
+end
+
+# Contents of the files of a directory tree, indexed by their relative paths.
+# The manifest, which lists the absolute paths of the outputs, is excluded.
+function tree_contents(root)
+    files = Dict{String, Vector{UInt8}}()
+    for (dir, _, fnames) in walkdir(root), f in fnames
+        endswith(f, "-manifest.txt") && continue
+        files[relpath(joinpath(dir, f), root)] = read(joinpath(dir, f))
+    end
+    files
+end
+
+function runtest()
+    @testset "Parallel generation test" begin
+        @test M.area(M.Square(2.)) == 4.
+        @test M.scaled_area(M.Circle(1.)) == 6.
+        @test M.center(M.Circle(1.)) == M.Point(1., 2.)
+        @test M.sides_array(M.Square(3.)) == fill(3., 4)
+        @test M.hypot2.([1., 2.], [2., 2.]) == [5., 8.]
+        @test M.total([1., 2., 3.]) == 6.
+        @test M.twice(Int32(4)) == 8
+
+        serial = tree_contents(generate(1))
+        @test count(f -> endswith(f, ".cxx"), keys(serial)) > 3
+        for njobs in (2, 4)
+            parallel = tree_contents(generate(njobs))
+            @test sort(collect(keys(parallel))) == sort(collect(keys(serial)))
+            # files differing from the serial run:
+            @test [f for f in keys(serial) if get(parallel, f, nothing) != serial[f]] == String[]
+        end
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
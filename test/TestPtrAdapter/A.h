@@ -0,0 +1,14 @@
+struct Counter {
+  Counter(int start = 0): n_(start){}
+  int count() const { return n_; }
+  void add(int n = 1){ n_ += n; }
+private:
+  int n_;
+};
+
+struct ScaledCounter: public Counter {
+  ScaledCounter(int factor): factor_(factor){}
+  int scaled() const { return factor_ * count(); }
+private:
+  int factor_;
+};
@@ -0,0 +1,67 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestPtrAdapter")
+using TestPtrAdapter
+
+using CxxWrap: CxxPtr, ConstCxxPtr
+
+const M = TestPtrAdapter
+
+# wrapit command, as found by the cmake configuration (WRAPIT cache variable)
+wrapit = let cache = read(joinpath(@__DIR__, "build", "CMakeCache.txt"), String)
+    m = match(r"^WRAPIT:[A-Z]+=(.+)$"m, cache)
+    m === nothing && error("WRAPIT is not defined in the CMake cache of the test build")
+    String(m[1])
+end
+
+# Number of method lambdas reported by wrapit for a method wrapper strategy
+function nlambdas(strategy)
+    out_dir = joinpath(@__DIR__, "build", strategy)
+    rm(out_dir, force=true, recursive=true)
+    run(Cmd(`$wrapit --force --add-cfg "method_wrapper_strategy=\"$strategy\"" --output-prefix $out_dir TestPtrAdapter.wit`,
+            dir=@__DIR__))
+    report = read(joinpath(out_dir, "jlTestPtrAdapter-report.txt"), String)
+    m = match(r"Number of lambda functions generated for the methods \(method_wrapper_strategy = \w+\): (\d+)", report)
+    parse(Int, m[1])
+end
+
+function runtest()
+    @testset "Method calls on pointers test" begin
+        c = M.Counter(1)
+        p = CxxPtr(c)
+        cp = ConstCxxPtr(c)
+
+        # calls on the instance, wrapped with the reference receiver lambdas
+        @test M.count(c) == 1
+
+        # calls forwarded by the pointer adapters
+        M.add(p)
+        @test M.count(p) == 2
+        M.add(p, 3)
+        @test M.count(cp) == 5
+        @test M.count(c) == 5
+
+        # methods inherited from a parent class
+        s = M.ScaledCounter(10)
+        sp = CxxPtr(s)
+        M.add(sp, 2)
+        @test M.count(sp) == 2
+        @test M.scaled(sp) == 20
+        @test M.scaled(ConstCxxPtr(s)) == 20
+
+        # the pointer receiver lambdas are no longer generated
+        n_lambdas = nlambdas("lambdas")
+        n_ptr_adapter = nlambdas("ptr_adapter")
+        @test n_ptr_adapter < n_lambdas
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
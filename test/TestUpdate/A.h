@@ -0,0 +1,5 @@
+struct A {
+  int f() const { return 1; }
+};
+
+int g(){ return 2; }
@@ -0,0 +1,70 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestUpdate")
+using TestUpdate
+
+# wrapit command, as found by the cmake configuration (WRAPIT cache variable)
+wrapit = let cache = read(joinpath(@__DIR__, "build", "CMakeCache.txt"), String)
+    m = match(r"^WRAPIT:[A-Z]+=(.+)$"m, cache)
+    m === nothing && error("WRAPIT is not defined in the CMake cache of the test build")
+    String(m[1])
+end
+
+# Output area of the update mode tests, separated from the build area
+# of the TestUpdate module
+out_dir = joinpath(@__DIR__, "build", "update_test")
+manifest = joinpath(out_dir, "jlTestUpdate-manifest.txt")
+
+# Runs wrapit in update mode and tells if the code generation was skipped
+function generation_skipped(extra_opts=String[])
+    err = Pipe()
+    run(pipeline(Cmd(`$wrapit --force --update --output-prefix $out_dir $extra_opts TestUpdate.wit`,
+                     dir=@__DIR__), stderr=err))
+    close(err.in)
+    occursin("generation skipped", read(err, String))
+end
+
+function runtest()
+    @testset "Update mode test" begin
+        @test TestUpdate.g() == 2
+        @test TestUpdate.f(TestUpdate.A()) == 1
+
+        rm(out_dir, force=true, recursive=true)
+        @test !generation_skipped()
+        @test generation_skipped()
+
+        # A manifest written by another wrapit version must not be trusted
+        wrapit_version = "version " * readchomp(`$wrapit --version`)[length("WrapIt! version ")+1:end]
+        lines = readlines(manifest)
+        @test wrapit_version in lines
+        write(manifest, join(replace(lines, wrapit_version => "version other"), "\n") * "\n")
+        @test !generation_skipped()
+        @test wrapit_version in readlines(manifest)
+        @test generation_skipped()
+
+        # Command line options that change the output are part of the configuration digest
+        @test !generation_skipped(["--ignore-parsing-errors"])
+        @test generation_skipped(["--ignore-parsing-errors"])
+        @test !generation_skipped()
+
+        # Outside update mode, the unchanged class wrapper files are not rewritten
+        generate() = run(Cmd(`$wrapit --force --add-cfg n_classes_per_file=-1 --output-prefix $out_dir TestUpdate.wit`,
+                             dir=@__DIR__))
+        generate()
+        type_file = joinpath(out_dir, "libTestUpdate", "src", "JlA.cxx")
+        t0 = mtime(type_file)
+        sleep(1.1)
+        generate()
+        @test mtime(type_file) == t0
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
@@ -0,0 +1,23 @@
+#include <vector>
+
+class A {
+public:
+  A(): data_{1., 2., 3.} {}
+  std::vector<double>& elements() { return data_; }
+  const std::vector<double>& celements() const { return data_; }
+  std::vector<int> counts() const { return {1, 2}; }
+  double add_up(const std::vector<double>& v) const {
+    double s = 0;
+    for(auto x: v) s += x;
+    return s;
+  }
+  void assign(std::vector<double> v) { data_ = v; }
+private:
+  std::vector<double> data_;
+};
+
+int total(const std::vector<int>& v, int offset){
+  int s = offset;
+  for(auto x: v) s += x;
+  return s;
+}
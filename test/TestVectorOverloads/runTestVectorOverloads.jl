@@ -0,0 +1,44 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestVectorOverloads")
+using TestVectorOverloads
+using CxxWrap
+
+const M = TestVectorOverloads
+
+function runtest()
+    @testset "std::vector overloads test" begin
+        a = M.A()
+
+        # std::vector arguments passed as Julia arrays
+        @test M.add_up(a, [1.0, 2.5]) == 3.5
+        @test M.add_up(a, StdVector([1.0, 2.5])) == 3.5
+        @test M.total(Int32[1, 2, 3], Int32(1)) == 7
+        M.assign(a, [4.0, 5.0])
+
+        # std::vector returned by non-const reference: view without copy
+        v = M.elements_view(a)
+        @test v == [4.0, 5.0]
+        v[1] = 10.0
+        @test M.celements_array(a) == [10.0, 5.0]
+
+        # std::vector returned by const reference or by value: copy
+        @test !isdefined(M, :celements_view)
+        c = M.celements_array(a)
+        c[1] = -1.0
+        @test M.elements_view(a)[1] == 10.0
+        counts = M.counts_array(a)
+        @test counts isa Vector{Int32}
+        @test counts == [1, 2]
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
@@ -0,0 +1,14 @@
+// Functions and methods selected by the veto file veto.txt. The comment
+// of each one tells whether it must be wrapped.
+
+struct A {
+  int kept() const { return 1; }             //wrapped, not in the veto file
+  int exact_vetoed() const { return 2; }     //vetoed by its exact signature
+  int in_regex_vetoed() const { return 3; }  //vetoed by a regex
+  int in_regex_unvetoed(int i) const { return i; } //regex veto undone by a later '+' line
+  int in_regex_revetoed() const { return 5; }      //'+' line undone by a later regex
+  int exact_unvetoed() const { return 6; }         //exact veto undone by a later '+' regex
+};
+
+inline int global_kept(int i){ return i; }    //wrapped
+inline int global_vetoed(int i){ return -i; } //vetoed by its exact signature
@@ -0,0 +1,40 @@
+using Test
+using Serialization
+
+import Pkg
+Pkg.activate("$(@__DIR__)/build")
+Pkg.develop(path="$(@__DIR__)/build/TestVetoList")
+using TestVetoList
+
+function runtest()
+    @testset "Veto list" begin
+        a = TestVetoList.A()
+
+        # not in the veto file:
+        @test kept(a) == 1
+        @test global_kept(3) == 3
+
+        # vetoed by an exact signature line:
+        @test !isdefined(TestVetoList, :exact_vetoed)
+        @test !isdefined(TestVetoList, :global_vetoed)
+
+        # vetoed by a regex line:
+        @test !isdefined(TestVetoList, :in_regex_vetoed)
+
+        # regex veto undone by a later '+' line:
+        @test in_regex_unvetoed(a, 4) == 4
+
+        # '+' line undone by a later regex line:
+        @test !isdefined(TestVetoList, :in_regex_revetoed)
+
+        # exact veto undone by a later '+' regex line:
+        @test exact_unvetoed(a) == 6
+    end
+end
+
+if "-s" in ARGS #Serialize mode
+    Test.TESTSET_PRINT_ENABLE[] = false
+    serialize(stdout, runtest())
+else
+    runtest()
+end
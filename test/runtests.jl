@@ -5,7 +5,10 @@ using Serialization
 tests = [ "TestSizet", "TestCtorDefVal", "TestAccessAndDelete", "TestNoFinalizer", "TestInheritance", "TestMultipleInheritanceOff",
           "TestPropagation",  "TestTemplate1",  "TestTemplate2", "TestVarField", "TestStdString", "TestStringView",
 	  "TestStdVector", "TestOperators", "TestEnum", "TestPointers", "TestEmptyClass", "TestUsingType", "TestNamespace",
-          "TestOrder", "TestAutoAdd", "TestAbstractClass", "TestAnonymousStruct", "TestFuncPtr", "TestDeduplication"
+          "TestOrder", "TestAutoAdd", "TestAbstractClass", "TestAnonymousStruct", "TestFuncPtr", "TestDeduplication",
+          "TestUpdate", "TestLazyRegistration", "TestBroadcast", "TestVectorOverloads", "TestIsbits", "TestCcall",
+          "TestParallelGeneration", "TestMultiUnit", "TestBuildTester", "TestLibSplit", "TestPtrAdapter",
+          "TestBalancedFiles", "TestVetoList"
           ]
 
 # Switch to test examples